@@ -0,0 +1,452 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ClipStage.h"
+#include "Shape.h"
+#include "SoftwareRenderer.h"
+#include "ThreadPool.h"
+
+// Clips every polygon of a file against every window of another one, without any
+// window or GPU. Both files hold one shape per line : "x1 y1 x2 y2 ...", lines
+// starting with '#' are ignored.
+//
+// usage : ClipBatch [--triangulate] [--exact] [--no-grid] [--threads n] [--image file] [--antialias] <polygons> <windows> [output]
+//         ClipBatch --boolean <operation> [--image file] [--antialias] <polygons> <windows> [output]
+//         ClipBatch [--triangulate] [--threads n] --bench
+//   --triangulate : ear clip the concave windows and run sutherland-hodgman against
+//                   every triangle (and convex window) instead of running
+//                   greiner-hormann against the concave windows
+//   --exact       : run sutherland-hodgman on the integer grid
+//   --no-grid     : test every polygon / window pair instead of using a spatial grid
+//   --threads n   : clip on n threads, 0 (default) uses every core and 1 the main thread only
+//   --boolean op  : instead of clipping, compute polygons <op> windows as a single shape,
+//                   op being union, intersection, difference or xor
+//   --image file  : draw the scene on the cpu into a ppm image, with the colors of the
+//                   application : polygons in red, windows in blue, results filled in green
+//   --antialias   : fill the results of the image with their exact pixel coverage
+//   --bench       : clip random scenes of growing size, with and without the grid,
+//                   and with the grid on the thread pool
+
+using Clock = std::chrono::steady_clock;
+
+static bool load_shapes(const char* path, std::vector<Shape>& shapes)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cerr << "Can't open " << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::istringstream stream(line);
+        std::vector<float> coordinates;
+        float value;
+        while (stream >> value)
+            coordinates.push_back(value);
+
+        // - a shape needs at least a triangle
+        if (coordinates.size() < 6)
+            continue;
+
+        coordinates.resize(coordinates.size() & ~size_t(1));
+        shapes.emplace_back();
+        shapes.back().setPoints(std::move(coordinates));
+    }
+
+    return true;
+}
+
+static void write_shape(std::ostream& out, const Shape& shape)
+{
+    // - one line per contour
+    const auto& points = shape.points();
+    for (int contour = 0; contour < shape.contours(); contour++)
+    {
+        for (int i = shape.contourBegin(contour); i < shape.contourEnd(contour); i++)
+            out << (i == shape.contourBegin(contour) ? "" : " ") << points[i * 2] << ' ' << points[i * 2 + 1];
+        out << '\n';
+    }
+}
+
+// - same colors as the application
+static const float POLYGON_COLOR[4] = { 1.0f, 0.0f, 0.0f, 1.0f };
+static const float WINDOW_COLOR[4] = { 0.0f, 0.0f, 1.0f, 1.0f };
+static const float RESULT_COLOR[4] = { 0.0f, 1.0f, 0.0f, 1.0f };
+// - largest image side
+static const int MAX_IMAGE_SIZE = 8192;
+
+// - big enough for the whole scene, in pixel coordinates like the application
+static std::unique_ptr<SoftwareRenderer> create_image(const std::vector<Shape>& polygons, const std::vector<Shape>& windows)
+{
+    float width = 1.0f;
+    float height = 1.0f;
+
+    for (const auto* shapes : { &polygons, &windows })
+    {
+        for (const auto& shape : *shapes)
+        {
+            const BoundingBox box = shape.bounds();
+            if (box.empty())
+                continue;
+
+            width = std::max(width, box.x_max + 1.0f);
+            height = std::max(height, box.y_max + 1.0f);
+        }
+    }
+
+    auto image = std::make_unique<SoftwareRenderer>(std::min(int(width), MAX_IMAGE_SIZE), std::min(int(height), MAX_IMAGE_SIZE));
+    image->clear(0.0f, 0.0f, 0.0f, 1.0f);
+
+    for (const auto& polygon : polygons)
+        image->drawOutline(polygon, POLYGON_COLOR);
+    for (const auto& window : windows)
+        image->drawOutline(window, WINDOW_COLOR);
+
+    return image;
+}
+
+static void draw_result(SoftwareRenderer& image, const Shape& result, bool antialias)
+{
+    image.drawOutline(result, RESULT_COLOR);
+
+    if (antialias)
+    {
+        CoverageMask mask;
+        result.fillCoverage(mask);
+        image.drawCoverage(mask, result.translation(), RESULT_COLOR);
+    }
+    else
+    {
+        std::vector<float> lines;
+        result.fill_LCA(lines);
+        image.drawLines(lines, result.translation(), RESULT_COLOR);
+    }
+}
+
+struct ClipCounters
+{
+    size_t tested = 0;
+    size_t clipped = 0;
+    size_t results = 0;
+    size_t result_vertices = 0;
+};
+
+static double elapsed_ms(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// - groups holds the window index of each triangle, so the fragments of a polygon
+// clipped by one window are merged back
+static void triangulate_windows(std::vector<Shape>& windows, std::vector<Shape>& triangles, std::vector<int>& groups)
+{
+    for (auto& window : windows)
+    {
+        // - convex windows are clipped against as they are
+        if (window.convex())
+        {
+            triangles.emplace_back();
+            triangles.back().setPoints(window.points());
+            groups.push_back(&window - windows.data());
+            continue;
+        }
+
+        std::vector<float> points;
+        window.ear_clipping(points);
+
+        for (size_t i = 0; i + 5 < points.size(); i += 6)
+        {
+            triangles.emplace_back();
+            triangles.back().addPoints(&points[i], 3);
+            groups.push_back(&window - windows.data());
+        }
+    }
+}
+
+static void clip_all(const std::vector<Shape>& polygons, const std::vector<Shape>& clippers, const std::vector<int>& groups, bool triangulate, bool exact, bool use_grid, ThreadPool* pool, std::ofstream& output, ClipCounters& counters, SoftwareRenderer* image = nullptr, bool antialias = false)
+{
+    std::vector<const Shape*> polygon_ptrs;
+    for (const auto& polygon : polygons)
+        polygon_ptrs.push_back(&polygon);
+
+    std::vector<const Shape*> clipper_ptrs;
+    for (const auto& clipper : clippers)
+        clipper_ptrs.push_back(&clipper);
+
+    ClipStage stage;
+    stage.setExact(exact);
+    stage.setGroups(groups);
+    stage.run(polygon_ptrs, clipper_ptrs, !triangulate, pool, use_grid);
+
+    counters.tested += stage.tested();
+    counters.clipped += stage.clipped();
+
+    // - results come back in the single threaded order whatever the thread count
+    for (int i = 0; i < stage.size(); i++)
+    {
+        counters.results++;
+        counters.result_vertices += stage.result(i).size();
+        if (output.is_open())
+            write_shape(output, stage.result(i));
+        if (image != nullptr)
+            draw_result(*image, stage.result(i), antialias);
+    }
+}
+
+static bool parse_operation(const std::string& name, BooleanOperation& operation)
+{
+    const char* names[] = { "union", "intersection", "difference", "xor" };
+    for (int i = 0; i < 4; i++)
+    {
+        if (name == names[i])
+        {
+            operation = BooleanOperation(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static Shape random_shape(std::mt19937& rng, float x, float y, float radius, int vertices)
+{
+    // - star shaped, so it can be concave but never self intersecting
+    std::uniform_real_distribution<float> distance(0.4f * radius, radius);
+    std::vector<float> points;
+
+    for (int i = 0; i < vertices; i++)
+    {
+        const float angle = 6.2831853f * i / vertices;
+        const float r = distance(rng);
+        points.push_back(std::floor(x + r * std::cos(angle)));
+        points.push_back(std::floor(y + r * std::sin(angle)));
+    }
+
+    Shape shape;
+    shape.setPoints(std::move(points));
+    return shape;
+}
+
+static void run_benchmark(bool triangulate, ThreadPool& pool)
+{
+    // - the scene grows with a constant density, so the work really needed grows
+    // linearly with its size while the number of pairs grows quadratically
+    std::cout << "scale  polygons  windows  pairs       grid (ms)  all pairs (ms)  grid, " << pool.threads() << " threads (ms)" << std::endl;
+
+    for (int scale = 1; scale <= 16; scale *= 2)
+    {
+        std::mt19937 rng(scale);
+        const float side = 1000.0f * std::sqrt(float(scale));
+        std::uniform_real_distribution<float> position(0.0f, side);
+        std::uniform_int_distribution<int> vertices(3, 12);
+
+        std::vector<Shape> polygons;
+        std::vector<Shape> windows;
+        for (int i = 0; i < 1000 * scale; i++)
+            polygons.push_back(random_shape(rng, position(rng), position(rng), 20.0f, vertices(rng)));
+        for (int i = 0; i < 50 * scale; i++)
+            windows.push_back(random_shape(rng, position(rng), position(rng), 80.0f, vertices(rng)));
+
+        std::vector<Shape> triangles;
+        std::vector<int> groups;
+        if (triangulate)
+            triangulate_windows(windows, triangles, groups);
+        const std::vector<Shape>& clippers = triangulate ? triangles : windows;
+
+        std::ofstream no_output;
+        ClipCounters grid_counters;
+        ClipCounters all_counters;
+        ClipCounters threaded_counters;
+
+        auto start = Clock::now();
+        clip_all(polygons, clippers, groups, triangulate, false, true, nullptr, no_output, grid_counters);
+        const double grid_time = elapsed_ms(start);
+
+        start = Clock::now();
+        clip_all(polygons, clippers, groups, triangulate, false, false, nullptr, no_output, all_counters);
+        const double all_time = elapsed_ms(start);
+
+        start = Clock::now();
+        clip_all(polygons, clippers, groups, triangulate, false, true, &pool, no_output, threaded_counters);
+        const double threaded_time = elapsed_ms(start);
+
+        std::cout << scale << "\t" << polygons.size() << "\t  " << clippers.size() << "\t   "
+                  << polygons.size() * clippers.size() << "\t" << grid_time << "\t   " << all_time
+                  << "\t\t   " << threaded_time << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bool triangulate = false;
+    bool exact = false;
+    bool use_grid = true;
+    bool bench = false;
+    bool boolean = false;
+    BooleanOperation operation = BooleanOperation::Union;
+    int threads = 0;
+    const char* image_path = nullptr;
+    bool antialias = false;
+    std::vector<const char*> paths;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string argument = argv[i];
+        if (argument == "--triangulate")
+            triangulate = true;
+        else if (argument == "--exact")
+            exact = true;
+        else if (argument == "--no-grid")
+            use_grid = false;
+        else if (argument == "--threads" && i + 1 < argc)
+            threads = std::atoi(argv[++i]);
+        else if (argument == "--image" && i + 1 < argc)
+            image_path = argv[++i];
+        else if (argument == "--antialias")
+            antialias = true;
+        else if (argument == "--bench")
+            bench = true;
+        else if (argument == "--boolean" && i + 1 < argc)
+        {
+            boolean = true;
+            if (!parse_operation(argv[++i], operation))
+            {
+                std::cerr << "Unknown operation " << argv[i] << ", expected union, intersection, difference or xor" << std::endl;
+                return -1;
+            }
+        }
+        else
+            paths.push_back(argv[i]);
+    }
+
+    // - the main thread is one of the pool threads
+    ThreadPool pool(threads);
+
+    if (bench)
+    {
+        run_benchmark(triangulate, pool);
+        return 0;
+    }
+
+    if (paths.size() < 2)
+    {
+        std::cerr << "usage : " << argv[0] << " [--triangulate] [--exact] [--no-grid] [--threads n] [--image file] [--antialias] <polygons> <windows> [output]" << std::endl;
+        std::cerr << "        " << argv[0] << " --boolean <operation> [--image file] [--antialias] <polygons> <windows> [output]" << std::endl;
+        std::cerr << "        " << argv[0] << " [--triangulate] [--threads n] --bench" << std::endl;
+        return -1;
+    }
+
+    std::vector<Shape> polygons;
+    std::vector<Shape> windows;
+
+    auto start = Clock::now();
+    if (!load_shapes(paths[0], polygons) || !load_shapes(paths[1], windows))
+        return -1;
+    const double load_time = elapsed_ms(start);
+
+    std::unique_ptr<SoftwareRenderer> image;
+    if (image_path != nullptr)
+        image = create_image(polygons, windows);
+
+    if (boolean)
+    {
+        std::vector<const Shape*> subject;
+        for (const auto& polygon : polygons)
+            subject.push_back(&polygon);
+
+        std::vector<const Shape*> clipping;
+        for (const auto& window : windows)
+            clipping.push_back(&window);
+
+        start = Clock::now();
+        Shape result;
+        result.booleanOperation(subject, clipping, operation);
+        const double boolean_time = elapsed_ms(start);
+
+        if (paths.size() > 2)
+        {
+            std::ofstream output(paths[2]);
+            write_shape(output, result);
+        }
+
+        double image_time = 0.0;
+        if (image != nullptr)
+        {
+            start = Clock::now();
+            draw_result(*image, result, antialias);
+            image->flush(&pool);
+            image_time = elapsed_ms(start);
+            image->writePPM(image_path);
+        }
+
+        std::cout << "polygons      : " << polygons.size() << '\n'
+                  << "windows       : " << windows.size() << '\n'
+                  << "result        : " << (result.size() == 0 ? 0 : result.contours()) << " contours (" << result.size() << " vertices)\n"
+                  << "load          : " << load_time << " ms\n"
+                  << "boolean       : " << boolean_time << " ms" << std::endl;
+        if (image != nullptr)
+            std::cout << "image         : " << image->width() << " x " << image->height() << ", " << image_time << " ms to fill and rasterize" << std::endl;
+        return 0;
+    }
+
+    // - same pipeline as the application : with --triangulate windows are ear clipped
+    // first because sutherland-hodgman only works against convex windows
+    start = Clock::now();
+    std::vector<Shape> triangles;
+    std::vector<int> groups;
+    if (triangulate)
+        triangulate_windows(windows, triangles, groups);
+    const double triangulation_time = elapsed_ms(start);
+    const std::vector<Shape>& clippers = triangulate ? triangles : windows;
+
+    std::ofstream output;
+    if (paths.size() > 2)
+        output.open(paths[2]);
+
+    start = Clock::now();
+    ClipCounters counters;
+    clip_all(polygons, clippers, groups, triangulate, exact, use_grid, &pool, output, counters, image.get(), antialias);
+    const double clip_time = elapsed_ms(start);
+
+    double image_time = 0.0;
+    if (image != nullptr)
+    {
+        start = Clock::now();
+        image->flush(&pool);
+        image_time = elapsed_ms(start);
+        image->writePPM(image_path);
+    }
+    const size_t pairs = polygons.size() * clippers.size();
+
+    std::cout << "polygons      : " << polygons.size() << '\n'
+              << "windows       : " << windows.size();
+    if (triangulate)
+        std::cout << " (" << triangles.size() << " convex windows and triangles)";
+    std::cout << '\n'
+              << "pairs         : " << pairs << " (" << counters.tested << " tested, " << counters.clipped << " clipped)\n"
+              << "results       : " << counters.results << " (" << counters.result_vertices << " vertices)\n"
+              << "load          : " << load_time << " ms\n"
+              << "triangulation : " << triangulation_time << " ms\n"
+              << "clipping      : " << clip_time << " ms on " << pool.threads() << " threads";
+    if (clip_time > 0.0)
+        std::cout << " (" << pairs / clip_time * 1000.0 << " pairs/s)";
+    std::cout << std::endl;
+    if (image != nullptr)
+        std::cout << "image         : " << image->width() << " x " << image->height() << ", " << image_time << " ms to rasterize" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,585 @@
+#include <algorithm>
+#include <cmath>
+
+#include "BooleanSweep.h"
+
+// - squared sine of the angle under which two edges are parallel
+static const double PARALLEL_EPSILON = 1e-10;
+// - crossings closer than this (squared) to an end point are moved onto it
+static const double SNAP_EPSILON = 1e-12;
+
+// - positive when (x2, y2) is on the left of (x0, y0) -> (x1, y1)
+static double signed_area(double x0, double y0, double x1, double y1, double x2, double y2)
+{
+    return (x0 - x2) * (y1 - y2) - (x1 - x2) * (y0 - y2);
+}
+
+void BooleanSweep::addShape(int operand, const std::vector<double>& points, const std::vector<int>& contour_ends)
+{
+    const int size = points.size() / 2;
+    const int contours = contour_ends.empty() ? 1 : contour_ends.size();
+
+    // - the orientation of the whole shape tells what inside is, so its holes are the
+    // contours turning the other way
+    double area = 0.0;
+    for (int c = 0; c < contours; c++)
+    {
+        const int begin = c == 0 ? 0 : contour_ends[c - 1];
+        const int end = contour_ends.empty() ? size : contour_ends[c];
+        for (int i = begin; i < end; i++)
+        {
+            const int j = i + 1 == end ? begin : i + 1;
+            area += points[i * 2] * points[j * 2 + 1] - points[j * 2] * points[i * 2 + 1];
+        }
+    }
+
+    if (area == 0.0)
+        return;
+
+    const int sign = area > 0.0 ? 1 : -1;
+
+    for (int c = 0; c < contours; c++)
+    {
+        const int begin = c == 0 ? 0 : contour_ends[c - 1];
+        const int end = contour_ends.empty() ? size : contour_ends[c];
+        if (end - begin < 3)
+            continue;
+
+        for (int i = begin; i < end; i++)
+        {
+            const int j = i + 1 == end ? begin : i + 1;
+            const double x1 = points[i * 2];
+            const double y1 = points[i * 2 + 1];
+            const double x2 = points[j * 2];
+            const double y2 = points[j * 2 + 1];
+
+            if (x1 == x2 && y1 == y2)
+                continue;
+
+            // - the inside of a counter clockwise contour is on the left of its edges, so
+            // above an edge going left to right
+            const bool forward = x1 < x2 || (x1 == x2 && y1 < y2);
+            if (forward)
+                mLines_.push_back({ x1, y1, x2, y2 });
+            else
+                mLines_.push_back({ x2, y2, x1, y1 });
+
+            const int e1 = add_event(x1, y1, forward, mLines_.size() - 1);
+            const int e2 = add_event(x2, y2, !forward, mLines_.size() - 1);
+            mEvents_[e1].other = e2;
+            mEvents_[e2].other = e1;
+
+            const int left = forward ? e1 : e2;
+            mEvents_[left].wind[operand] = forward ? sign : -sign;
+        }
+
+        for (int i = begin; i < end; i++)
+        {
+            mMaxX_[operand] = mEmpty_[operand] ? points[i * 2] : std::max(mMaxX_[operand], points[i * 2]);
+            mEmpty_[operand] = false;
+        }
+    }
+}
+
+void BooleanSweep::compute(BooleanOperation operation, std::vector<float>& points, std::vector<int>& contour_ends)
+{
+    mOperation_ = operation;
+
+    mQueue_.resize(mEvents_.size());
+    for (size_t i = 0; i < mEvents_.size(); i++)
+        mQueue_[i] = i;
+
+    const Later later_event{ this };
+    std::make_heap(mQueue_.begin(), mQueue_.end(), later_event);
+
+    // - past the end of the subject nothing is left of a difference, and past the end
+    // of either operand nothing is left of an intersection
+    double stop_x = HUGE_VAL;
+    if (operation == BooleanOperation::Difference)
+        stop_x = mEmpty_[0] ? -HUGE_VAL : mMaxX_[0];
+    else if (operation == BooleanOperation::Intersection)
+        stop_x = mEmpty_[0] || mEmpty_[1] ? -HUGE_VAL : std::min(mMaxX_[0], mMaxX_[1]);
+
+    Status& status = mStatus_;
+    mPositions_.assign(mEvents_.size(), status.end());
+
+    while (!mQueue_.empty())
+    {
+        std::pop_heap(mQueue_.begin(), mQueue_.end(), later_event);
+        const int e = mQueue_.back();
+        mQueue_.pop_back();
+
+        if (mEvents_[e].x > stop_x)
+            break;
+
+        if (mEvents_[e].left)
+        {
+            const auto position = status.insert(e).first;
+            mPositions_[e] = position;
+
+            auto next = std::next(position);
+            const int previous = position == status.begin() ? -1 : *std::prev(position);
+
+            compute_fields(e, previous);
+
+            if (next != status.end() && possible_intersection(e, *next) == 2)
+            {
+                compute_fields(e, previous);
+                compute_fields(*next, e);
+            }
+
+            if (previous != -1 && possible_intersection(previous, e) == 2)
+            {
+                const auto previous_position = mPositions_[previous];
+                const int before = previous_position == status.begin() ? -1 : *std::prev(previous_position);
+                compute_fields(previous, before);
+                compute_fields(e, previous);
+            }
+        }
+        else
+        {
+            // - the edge leaves the sweep line, its neighbours become adjacent
+            const int left = mEvents_[e].other;
+            const auto position = mPositions_[left];
+            if (position == status.end())
+                continue;
+
+            const auto next = std::next(position);
+            const int previous = position == status.begin() ? -1 : *std::prev(position);
+            const int following = next == status.end() ? -1 : *next;
+
+            status.erase(position);
+            mPositions_[left] = status.end();
+
+            if (previous != -1 && following != -1)
+                possible_intersection(previous, following);
+        }
+    }
+
+    connect(points, contour_ends);
+
+    mStatus_.clear();
+    mLines_.clear();
+    mEvents_.clear();
+    mQueue_.clear();
+    mPositions_.clear();
+    mEmpty_[0] = mEmpty_[1] = true;
+}
+
+int BooleanSweep::add_event(double x, double y, bool left, int line)
+{
+    Event event;
+    event.x = x;
+    event.y = y;
+    event.other = -1;
+    event.line = line;
+    event.left = left;
+    event.wind[0] = event.wind[1] = 0;
+    event.below[0] = event.below[1] = 0;
+    event.in_result = false;
+    event.result_above = false;
+
+    mEvents_.push_back(event);
+    return mEvents_.size() - 1;
+}
+
+bool BooleanSweep::later(int a, int b) const
+{
+    const Event& e1 = mEvents_[a];
+    const Event& e2 = mEvents_[b];
+
+    if (e1.x != e2.x)
+        return e1.x > e2.x;
+    if (e1.y != e2.y)
+        return e1.y > e2.y;
+
+    // - same point : edges leaving the sweep line first, then the lower edge first
+    if (e1.left != e2.left)
+        return e1.left;
+
+    const double turn = cross(a, b);
+    if (turn != 0.0)
+        return e1.left ? turn < 0.0 : turn > 0.0;
+
+    return a > b;
+}
+
+bool BooleanSweep::lower(int a, int b) const
+{
+    if (a == b)
+        return false;
+
+    const Event& l1 = mEvents_[a];
+    const Event& l2 = mEvents_[b];
+
+    if (!collinear(a, b))
+    {
+        // - same left end point : the directions tell
+        if (l1.x == l2.x && l1.y == l2.y)
+            return cross(a, b) > 0.0;
+
+        // - compare against the edge inserted first, with the directions when the left
+        // end point lies on it (a vertical edge passing there is above)
+        if (later(a, b))
+        {
+            const double area = side(b, l1.x, l1.y);
+            return area != 0.0 ? area < 0.0 : cross(b, a) < 0.0;
+        }
+
+        const double area = side(a, l2.x, l2.y);
+        return area != 0.0 ? area > 0.0 : cross(a, b) > 0.0;
+    }
+
+    // - collinear, any consistent order does
+    if (l1.x == l2.x && l1.y == l2.y)
+        return a < b;
+
+    return later(a, b);
+}
+
+double BooleanSweep::side(int e, double x, double y) const
+{
+    const Line& line = mLines_[mEvents_[e].line];
+    return signed_area(line.x1, line.y1, line.x2, line.y2, x, y);
+}
+
+double BooleanSweep::cross(int a, int b) const
+{
+    const Line& l1 = mLines_[mEvents_[a].line];
+    const Line& l2 = mLines_[mEvents_[b].line];
+    return (l1.x2 - l1.x1) * (l2.y2 - l2.y1) - (l1.y2 - l1.y1) * (l2.x2 - l2.x1);
+}
+
+bool BooleanSweep::collinear(int a, int b) const
+{
+    const Line& l1 = mLines_[mEvents_[a].line];
+    const Line& l2 = mLines_[mEvents_[b].line];
+    const double dx0 = l1.x2 - l1.x1;
+    const double dy0 = l1.y2 - l1.y1;
+    const double dx1 = l2.x2 - l2.x1;
+    const double dy1 = l2.y2 - l2.y1;
+    const double length0 = dx0 * dx0 + dy0 * dy0;
+    const double length1 = dx1 * dx1 + dy1 * dy1;
+
+    const double turn = dx0 * dy1 - dy0 * dx1;
+    if (turn * turn > PARALLEL_EPSILON * length0 * length1)
+        return false;
+
+    // - parallel, on the same line or not
+    const double ex = l2.x1 - l1.x1;
+    const double ey = l2.y1 - l1.y1;
+    const double offset = dx0 * ey - dy0 * ex;
+    return offset * offset <= PARALLEL_EPSILON * length0 * (ex * ex + ey * ey);
+}
+
+bool BooleanSweep::on_edge(int e, double x, double y) const
+{
+    // - (x, y) lies on the line of the edge, it only has to be between its end points
+    const Event& left = mEvents_[e];
+    const Event& right = mEvents_[left.other];
+
+    const bool after_left = x > left.x || (x == left.x && y >= left.y);
+    const bool before_right = x < right.x || (x == right.x && y <= right.y);
+    return after_left && before_right;
+}
+
+bool BooleanSweep::same_point(int a, int b) const
+{
+    return mEvents_[a].x == mEvents_[b].x && mEvents_[a].y == mEvents_[b].y;
+}
+
+bool BooleanSweep::inside(const int wind[2]) const
+{
+    // - non zero rule on each operand
+    const bool subject = wind[0] != 0;
+    const bool clipping = wind[1] != 0;
+
+    switch (mOperation_)
+    {
+    case BooleanOperation::Union:
+        return subject || clipping;
+    case BooleanOperation::Intersection:
+        return subject && clipping;
+    case BooleanOperation::Difference:
+        return subject && !clipping;
+    case BooleanOperation::Xor:
+        return subject != clipping;
+    }
+
+    return false;
+}
+
+void BooleanSweep::compute_fields(int e, int previous)
+{
+    Event& event = mEvents_[e];
+
+    for (int operand = 0; operand < 2; operand++)
+        event.below[operand] = previous == -1 ? 0 : mEvents_[previous].below[operand] + mEvents_[previous].wind[operand];
+
+    const int above[2] = { event.below[0] + event.wind[0], event.below[1] + event.wind[1] };
+    event.result_above = inside(above);
+    event.in_result = inside(event.below) != event.result_above;
+}
+
+int BooleanSweep::possible_intersection(int e1, int e2)
+{
+    // - e1 is right below e2 on the sweep line. Crossings are computed from the lines
+    // of the original edges, so every piece of an edge agrees on them
+    const int r1 = mEvents_[e1].other;
+    const int r2 = mEvents_[e2].other;
+
+    if (!collinear(e1, e2))
+    {
+        const Line& l1 = mLines_[mEvents_[e1].line];
+        const Line& l2 = mLines_[mEvents_[e2].line];
+        const double dx0 = l1.x2 - l1.x1;
+        const double dy0 = l1.y2 - l1.y1;
+        const double dx1 = l2.x2 - l2.x1;
+        const double dy1 = l2.y2 - l2.y1;
+        const double s = ((l2.x1 - l1.x1) * dy1 - (l2.y1 - l1.y1) * dx1) / (dx0 * dy1 - dy0 * dx1);
+
+        double x = l1.x1 + s * dx0;
+        double y = l1.y1 + s * dy0;
+
+        // - rounding errors must not leave a sliver next to an end point
+        for (int end : { e1, r1, e2, r2 })
+        {
+            const double sx = mEvents_[end].x - x;
+            const double sy = mEvents_[end].y - y;
+            if (sx * sx + sy * sy < SNAP_EPSILON)
+            {
+                x = mEvents_[end].x;
+                y = mEvents_[end].y;
+                break;
+            }
+        }
+
+        if (!on_edge(e1, x, y) || !on_edge(e2, x, y))
+            return 0;
+
+        const bool end_of_e1 = (x == mEvents_[e1].x && y == mEvents_[e1].y) || (x == mEvents_[r1].x && y == mEvents_[r1].y);
+        const bool end_of_e2 = (x == mEvents_[e2].x && y == mEvents_[e2].y) || (x == mEvents_[r2].x && y == mEvents_[r2].y);
+
+        // - edges meeting at an end point of both don't cross
+        if (end_of_e1 && end_of_e2)
+            return 0;
+
+        if (!end_of_e1)
+            divide(e1, x, y);
+        if (!end_of_e2)
+            divide(e2, x, y);
+
+        return 1;
+    }
+
+    // - same line, they overlap unless one ends before the other starts
+    if (!later(r1, e2) || !later(r2, e1))
+        return 0;
+
+    // - end points of both edges in sweep order, -1 where both edges share one
+    int sorted[4];
+    int count = 0;
+
+    if (same_point(e1, e2))
+        sorted[count++] = -1;
+    else if (later(e1, e2))
+    {
+        sorted[count++] = e2;
+        sorted[count++] = e1;
+    }
+    else
+    {
+        sorted[count++] = e1;
+        sorted[count++] = e2;
+    }
+
+    if (same_point(r1, r2))
+        sorted[count++] = -1;
+    else if (later(r1, r2))
+    {
+        sorted[count++] = r2;
+        sorted[count++] = r1;
+    }
+    else
+    {
+        sorted[count++] = r1;
+        sorted[count++] = r2;
+    }
+
+    if (count == 2 || (count == 3 && sorted[2] != -1))
+    {
+        // - same left end point : cut the longer edge at the end of the shorter one,
+        // then keep a single edge carrying the windings of both
+        if (count == 3)
+            divide(mEvents_[sorted[2]].other, mEvents_[sorted[1]].x, mEvents_[sorted[1]].y);
+
+        for (int operand = 0; operand < 2; operand++)
+        {
+            mEvents_[e2].wind[operand] += mEvents_[e1].wind[operand];
+            mEvents_[e1].wind[operand] = 0;
+        }
+
+        return 2;
+    }
+
+    if (count == 3)
+    {
+        // - same right end point : cut the edge starting first where the other starts
+        divide(sorted[0], mEvents_[sorted[1]].x, mEvents_[sorted[1]].y);
+        return 3;
+    }
+
+    if (sorted[0] != mEvents_[sorted[3]].other)
+    {
+        // - partial overlap
+        divide(sorted[0], mEvents_[sorted[1]].x, mEvents_[sorted[1]].y);
+        divide(sorted[1], mEvents_[sorted[2]].x, mEvents_[sorted[2]].y);
+        return 3;
+    }
+
+    // - one edge contains the other
+    divide(sorted[0], mEvents_[sorted[1]].x, mEvents_[sorted[1]].y);
+    divide(mEvents_[sorted[3]].other, mEvents_[sorted[2]].x, mEvents_[sorted[2]].y);
+    return 3;
+}
+
+void BooleanSweep::divide(int e, double x, double y)
+{
+    // - e now ends at (x, y), a new edge goes from there to its old right end point
+    const int right = mEvents_[e].other;
+    const int line = mEvents_[e].line;
+    const int end = add_event(x, y, false, line);
+    const int start = add_event(x, y, true, line);
+
+    mEvents_[end].other = e;
+    mEvents_[start].other = right;
+    mEvents_[start].wind[0] = mEvents_[e].wind[0];
+    mEvents_[start].wind[1] = mEvents_[e].wind[1];
+    mEvents_[e].other = end;
+    mEvents_[right].other = start;
+
+    // - a rounding error may put the cut past the right end point, the new edge is
+    // then swept the other way. Windings follow the line, they don't change
+    if (later(start, right))
+    {
+        mEvents_[right].left = true;
+        mEvents_[start].left = false;
+        mEvents_[right].wind[0] = mEvents_[start].wind[0];
+        mEvents_[right].wind[1] = mEvents_[start].wind[1];
+    }
+
+    mPositions_.resize(mEvents_.size(), mStatus_.end());
+
+    const Later later_event{ this };
+    mQueue_.push_back(end);
+    std::push_heap(mQueue_.begin(), mQueue_.end(), later_event);
+    mQueue_.push_back(start);
+    std::push_heap(mQueue_.begin(), mQueue_.end(), later_event);
+}
+
+void BooleanSweep::connect(std::vector<float>& points, std::vector<int>& contour_ends)
+{
+    // - result edges oriented with the result on their left
+    struct ResultEdge
+    {
+        double x1;
+        double y1;
+        double x2;
+        double y2;
+    };
+
+    std::vector<ResultEdge> edges;
+    for (const Event& event : mEvents_)
+    {
+        if (!event.left || !event.in_result)
+            continue;
+
+        // - the result is on the left of the line when it is above
+        const Event& other = mEvents_[event.other];
+        const Line& line = mLines_[event.line];
+        const bool along_line = (other.x - event.x) * (line.x2 - line.x1) + (other.y - event.y) * (line.y2 - line.y1) >= 0.0;
+
+        if (along_line == event.result_above)
+            edges.push_back({ event.x, event.y, other.x, other.y });
+        else
+            edges.push_back({ other.x, other.y, event.x, event.y });
+    }
+
+    // - edges sorted by start point, to find the ones leaving a point
+    std::vector<int> order(edges.size());
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+
+    auto starts_before = [&](int a, int b)
+    {
+        return edges[a].x1 < edges[b].x1 || (edges[a].x1 == edges[b].x1 && edges[a].y1 < edges[b].y1);
+    };
+    std::sort(order.begin(), order.end(), starts_before);
+
+    std::vector<char> used(edges.size(), 0);
+
+    for (int first : order)
+    {
+        if (used[first])
+            continue;
+
+        const size_t contour_begin = points.size();
+        int current = first;
+
+        for (;;)
+        {
+            used[current] = 1;
+            const ResultEdge& edge = edges[current];
+            points.push_back(float(edge.x1));
+            points.push_back(float(edge.y1));
+
+            if (edge.x2 == edges[first].x1 && edge.y2 == edges[first].y1)
+                break;
+
+            // - several edges leave a point where contours touch : the one turning the
+            // most to the left keeps each contour on its own
+            const auto range = std::equal_range(order.begin(), order.end(), -1, [&](int a, int b)
+            {
+                const double ax = a == -1 ? edge.x2 : edges[a].x1;
+                const double ay = a == -1 ? edge.y2 : edges[a].y1;
+                const double bx = b == -1 ? edge.x2 : edges[b].x1;
+                const double by = b == -1 ? edge.y2 : edges[b].y1;
+                return ax < bx || (ax == bx && ay < by);
+            });
+
+            const double dx = edge.x2 - edge.x1;
+            const double dy = edge.y2 - edge.y1;
+            int next = -1;
+            double best = 0.0;
+
+            for (auto it = range.first; it != range.second; ++it)
+            {
+                if (used[*it])
+                    continue;
+
+                const double nx = edges[*it].x2 - edges[*it].x1;
+                const double ny = edges[*it].y2 - edges[*it].y1;
+                const double turn = std::atan2(dx * ny - dy * nx, dx * nx + dy * ny);
+                if (next == -1 || turn > best)
+                {
+                    next = *it;
+                    best = turn;
+                }
+            }
+
+            // - an open chain only comes from rounding errors, it is dropped
+            if (next == -1)
+            {
+                points.resize(contour_begin);
+                break;
+            }
+
+            current = next;
+        }
+
+        if (points.size() - contour_begin >= 6)
+            contour_ends.push_back(points.size() / 2);
+        else
+            points.resize(contour_begin);
+    }
+}
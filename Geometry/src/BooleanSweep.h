@@ -0,0 +1,109 @@
+#pragma once
+
+#include <set>
+#include <vector>
+
+enum class BooleanOperation
+{
+    Union,
+    Intersection,
+    // - subject minus clipping
+    Difference,
+    Xor
+};
+
+// - boolean operations between two sets of contours with a plane sweep (Martinez-Rueda).
+// Edges are split where they cross, each piece gets from the piece below it how many
+// times each operand winds around the regions on both of its sides, and the pieces
+// with the result on one side only are chained into contours. O((n + k) log n) for n
+// edges crossing k times, whatever the number of contours
+class BooleanSweep
+{
+public:
+    BooleanSweep() : mStatus_(Lower{ this }) {}
+    BooleanSweep(const BooleanSweep&) = delete;
+    BooleanSweep& operator=(const BooleanSweep&) = delete;
+
+    // - adds the contours of a shape to an operand, 0 for the subject and 1 for the
+    // clipping. points are x, y pairs, contour_ends the end index (in points) of each
+    // contour, or empty for a single one. A contour turning the other way than the
+    // shape as a whole is a hole, and the shapes of an operand are united
+    void addShape(int operand, const std::vector<double>& points, const std::vector<int>& contour_ends);
+    // - result points are appended to points and the end index (in points) of each
+    // contour to contour_ends. Outer contours turn counter clockwise (positive area),
+    // holes clockwise. The operands are emptied
+    void compute(BooleanOperation operation, std::vector<float>& points, std::vector<int>& contour_ends);
+
+private:
+    // - original edge, from its left end point to its right one
+    struct Line
+    {
+        double x1;
+        double y1;
+        double x2;
+        double y2;
+    };
+
+    struct Event
+    {
+        double x;
+        double y;
+        // - the event at the other end of the edge, and the line of the original edge
+        // this one is a piece of
+        int other;
+        int line;
+        bool left;
+        // - left events only : winding change of each operand when crossing the line
+        // from its right side to its left side (upward), and winding of each operand
+        // just below the edge
+        int wind[2];
+        int below[2];
+        bool in_result;
+        // - the result lies above the edge, else below
+        bool result_above;
+    };
+
+    // - true when event a must be processed after event b
+    struct Later
+    {
+        const BooleanSweep* sweep;
+        bool operator()(int a, int b) const { return sweep->later(a, b); }
+    };
+
+    // - order of the edges crossed by the sweep line, from the bottom
+    struct Lower
+    {
+        const BooleanSweep* sweep;
+        bool operator()(int a, int b) const { return sweep->lower(a, b); }
+    };
+
+    using Status = std::set<int, Lower>;
+
+    int add_event(double x, double y, bool left, int line);
+    bool later(int a, int b) const;
+    bool lower(int a, int b) const;
+    // - positive when (x, y) is above the line of the edge
+    double side(int e, double x, double y) const;
+    // - positive when the line of b turns left from the line of a
+    double cross(int a, int b) const;
+    bool collinear(int a, int b) const;
+    bool on_edge(int e, double x, double y) const;
+    bool same_point(int a, int b) const;
+    bool inside(const int wind[2]) const;
+    void compute_fields(int e, int previous);
+    int possible_intersection(int e1, int e2);
+    void divide(int e, double x, double y);
+    void connect(std::vector<float>& points, std::vector<int>& contour_ends);
+
+    BooleanOperation mOperation_ = BooleanOperation::Union;
+    std::vector<Line> mLines_;
+    std::vector<Event> mEvents_;
+    // - heap of the events left, the earliest on top
+    std::vector<int> mQueue_;
+    Status mStatus_;
+    // - position of each left event in mStatus_, end() when it isn't there
+    std::vector<Status::iterator> mPositions_;
+    // - rightmost x of each operand, the sweep can stop early past them
+    double mMaxX_[2] = { 0.0, 0.0 };
+    bool mEmpty_[2] = { true, true };
+};
@@ -0,0 +1,232 @@
+#include <cmath>
+#include <algorithm>
+
+#include "ClipKernel.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define CLIP_KERNEL_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CLIP_KERNEL_SSE2
+#endif
+
+void ClipKernel::load(const float* points, int count)
+{
+    reserve(count);
+    mSize_ = count;
+
+    for (int i = 0; i < count; i++)
+    {
+        mX_[i] = points[i * 2];
+        mY_[i] = points[i * 2 + 1];
+    }
+}
+
+void ClipKernel::clip(float x1, float y1, float x2, float y2, bool snap)
+{
+    if (mSize_ == 0)
+        return;
+
+    reserve(mSize_);
+    mX_[mSize_] = mX_[0];
+    mY_[mSize_] = mY_[0];
+
+    classify(x1, y1, x2, y2);
+    compact(snap);
+}
+
+void ClipKernel::store(std::vector<float>& points) const
+{
+    points.resize(mSize_ * 2);
+
+    for (int i = 0; i < mSize_; i++)
+    {
+        points[i * 2] = mX_[i];
+        points[i * 2 + 1] = mY_[i];
+    }
+}
+
+void ClipKernel::reserve(int count)
+{
+    // - a clip line can at most double the number of points, plus the repeated first
+    // point and room for a full vector past the end
+    const size_t capacity = count * 2 + 9;
+    if (mX_.size() >= capacity)
+        return;
+
+    mX_.resize(capacity);
+    mY_.resize(capacity);
+    mCrossX_.resize(capacity);
+    mCrossY_.resize(capacity);
+    mCrosses_.resize(capacity);
+    mInside_.resize(capacity);
+    mOutX_.resize(capacity);
+    mOutY_.resize(capacity);
+}
+
+// - computes the same expressions, in the same order, as the scalar code so every
+// lane gives exactly the scalar result
+void ClipKernel::classify(float x1, float y1, float x2, float y2)
+{
+    const int n = mSize_;
+    const float* x = mX_.data();
+    const float* y = mY_.data();
+
+    // - clip line terms, shared by every side test and crossing
+    const float dx = x2 - x1;
+    const float dy = y2 - y1;
+    const float dx12 = x1 - x2;
+    const float dy12 = y1 - y2;
+    const float cross12 = x1 * y2 - y1 * x2;
+
+    int i = 0;
+
+#if defined(CLIP_KERNEL_AVX2)
+    const __m256 v_x1 = _mm256_set1_ps(x1);
+    const __m256 v_y1 = _mm256_set1_ps(y1);
+    const __m256 v_dx = _mm256_set1_ps(dx);
+    const __m256 v_dy = _mm256_set1_ps(dy);
+    const __m256 v_dx12 = _mm256_set1_ps(dx12);
+    const __m256 v_dy12 = _mm256_set1_ps(dy12);
+    const __m256 v_cross12 = _mm256_set1_ps(cross12);
+    const __m256 v_zero = _mm256_setzero_ps();
+    const __m256i v_one = _mm256_set1_epi32(1);
+
+    // - side of point i, for i in [0, n]
+    for (; i + 8 <= n + 1; i += 8)
+    {
+        const __m256 xi = _mm256_loadu_ps(x + i);
+        const __m256 yi = _mm256_loadu_ps(y + i);
+        const __m256 pos = _mm256_sub_ps(_mm256_mul_ps(v_dx, _mm256_sub_ps(yi, v_y1)), _mm256_mul_ps(v_dy, _mm256_sub_ps(xi, v_x1)));
+        const __m256i inside = _mm256_castps_si256(_mm256_cmp_ps(pos, v_zero, _CMP_LT_OQ));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&mInside_[i]), _mm256_and_si256(inside, v_one));
+    }
+#elif defined(CLIP_KERNEL_SSE2)
+    const __m128 v_x1 = _mm_set1_ps(x1);
+    const __m128 v_y1 = _mm_set1_ps(y1);
+    const __m128 v_dx = _mm_set1_ps(dx);
+    const __m128 v_dy = _mm_set1_ps(dy);
+    const __m128 v_dx12 = _mm_set1_ps(dx12);
+    const __m128 v_dy12 = _mm_set1_ps(dy12);
+    const __m128 v_cross12 = _mm_set1_ps(cross12);
+    const __m128 v_zero = _mm_setzero_ps();
+    const __m128i v_one = _mm_set1_epi32(1);
+
+    for (; i + 4 <= n + 1; i += 4)
+    {
+        const __m128 xi = _mm_loadu_ps(x + i);
+        const __m128 yi = _mm_loadu_ps(y + i);
+        const __m128 pos = _mm_sub_ps(_mm_mul_ps(v_dx, _mm_sub_ps(yi, v_y1)), _mm_mul_ps(v_dy, _mm_sub_ps(xi, v_x1)));
+        const __m128i inside = _mm_castps_si128(_mm_cmplt_ps(pos, v_zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&mInside_[i]), _mm_and_si128(inside, v_one));
+    }
+#endif
+
+    for (; i <= n; i++)
+    {
+        const float pos = dx * (y[i] - y1) - dy * (x[i] - x1);
+        mInside_[i] = pos < 0 ? 1 : 0;
+    }
+
+    // - crossing of every edge i -> i + 1 with the clip line, only kept when its end
+    // points are on different sides
+    i = 0;
+
+#if defined(CLIP_KERNEL_AVX2)
+    for (; i + 8 <= n; i += 8)
+    {
+        const __m256 x3 = _mm256_loadu_ps(x + i);
+        const __m256 y3 = _mm256_loadu_ps(y + i);
+        const __m256 x4 = _mm256_loadu_ps(x + i + 1);
+        const __m256 y4 = _mm256_loadu_ps(y + i + 1);
+
+        const __m256 dx34 = _mm256_sub_ps(x3, x4);
+        const __m256 dy34 = _mm256_sub_ps(y3, y4);
+        const __m256 cross34 = _mm256_sub_ps(_mm256_mul_ps(x3, y4), _mm256_mul_ps(y3, x4));
+        const __m256 den = _mm256_sub_ps(_mm256_mul_ps(v_dx12, dy34), _mm256_mul_ps(v_dy12, dx34));
+        const __m256 num_x = _mm256_sub_ps(_mm256_mul_ps(v_cross12, dx34), _mm256_mul_ps(v_dx12, cross34));
+        const __m256 num_y = _mm256_sub_ps(_mm256_mul_ps(v_cross12, dy34), _mm256_mul_ps(v_dy12, cross34));
+        _mm256_storeu_ps(&mCrossX_[i], _mm256_div_ps(num_x, den));
+        _mm256_storeu_ps(&mCrossY_[i], _mm256_div_ps(num_y, den));
+
+        const __m256i inside_i = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&mInside_[i]));
+        const __m256i inside_j = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&mInside_[i + 1]));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&mCrosses_[i]), _mm256_xor_si256(inside_i, inside_j));
+    }
+#elif defined(CLIP_KERNEL_SSE2)
+    for (; i + 4 <= n; i += 4)
+    {
+        const __m128 x3 = _mm_loadu_ps(x + i);
+        const __m128 y3 = _mm_loadu_ps(y + i);
+        const __m128 x4 = _mm_loadu_ps(x + i + 1);
+        const __m128 y4 = _mm_loadu_ps(y + i + 1);
+
+        const __m128 dx34 = _mm_sub_ps(x3, x4);
+        const __m128 dy34 = _mm_sub_ps(y3, y4);
+        const __m128 cross34 = _mm_sub_ps(_mm_mul_ps(x3, y4), _mm_mul_ps(y3, x4));
+        const __m128 den = _mm_sub_ps(_mm_mul_ps(v_dx12, dy34), _mm_mul_ps(v_dy12, dx34));
+        const __m128 num_x = _mm_sub_ps(_mm_mul_ps(v_cross12, dx34), _mm_mul_ps(v_dx12, cross34));
+        const __m128 num_y = _mm_sub_ps(_mm_mul_ps(v_cross12, dy34), _mm_mul_ps(v_dy12, cross34));
+        _mm_storeu_ps(&mCrossX_[i], _mm_div_ps(num_x, den));
+        _mm_storeu_ps(&mCrossY_[i], _mm_div_ps(num_y, den));
+
+        const __m128i inside_i = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&mInside_[i]));
+        const __m128i inside_j = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&mInside_[i + 1]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&mCrosses_[i]), _mm_xor_si128(inside_i, inside_j));
+    }
+#endif
+
+    for (; i < n; i++)
+    {
+        const float dx34 = x[i] - x[i + 1];
+        const float dy34 = y[i] - y[i + 1];
+        const float cross34 = x[i] * y[i + 1] - y[i] * x[i + 1];
+        const float den = dx12 * dy34 - dy12 * dx34;
+        mCrossX_[i] = (cross12 * dx34 - dx12 * cross34) / den;
+        mCrossY_[i] = (cross12 * dy34 - dy12 * cross34) / den;
+        mCrosses_[i] = mInside_[i] ^ mInside_[i + 1];
+    }
+}
+
+void ClipKernel::compact(bool snap)
+{
+    const int n = mSize_;
+    float* out_x = mOutX_.data();
+    float* out_y = mOutY_.data();
+    int count = 0;
+
+    // - edge i -> j gives its crossing if it has one, then j if it is inside. Both are
+    // always written and the output only moves forward when they are kept
+    for (int i = 0; i < n; i++)
+    {
+        out_x[count] = mCrossX_[i];
+        out_y[count] = mCrossY_[i];
+        count += mCrosses_[i];
+
+        out_x[count] = mX_[i + 1];
+        out_y[count] = mY_[i + 1];
+        count += mInside_[i + 1];
+    }
+
+    // - snap to the pixel grid
+    int i = snap ? 0 : count;
+
+#if defined(CLIP_KERNEL_AVX2)
+    for (; i + 8 <= count; i += 8)
+    {
+        _mm256_storeu_ps(out_x + i, _mm256_floor_ps(_mm256_loadu_ps(out_x + i)));
+        _mm256_storeu_ps(out_y + i, _mm256_floor_ps(_mm256_loadu_ps(out_y + i)));
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        out_x[i] = std::floor(out_x[i]);
+        out_y[i] = std::floor(out_y[i]);
+    }
+
+    std::swap(mX_, mOutX_);
+    std::swap(mY_, mOutY_);
+    mSize_ = count;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vector>
+
+// - sutherland-hodgman clipping of one polygon against successive clip lines. Points
+// are kept in separate x / y arrays so the side tests and the crossings of a whole
+// clip line are computed in one vectorized pass (AVX2 or SSE2 when the build targets
+// them, scalar otherwise), then the kept points are compacted without branching
+class ClipKernel
+{
+public:
+    // - interleaved x, y points of the polygon to clip
+    void load(const float* points, int count);
+    // - keep the part of the polygon on the inner side of (x1, y1) (x2, y2), points
+    // are snapped to the pixel grid unless snap is false
+    void clip(float x1, float y1, float x2, float y2, bool snap = true);
+    // - interleaved x, y points of the result
+    void store(std::vector<float>& points) const;
+    int size() const { return mSize_; }
+
+private:
+    void reserve(int count);
+    void classify(float x1, float y1, float x2, float y2);
+    void compact(bool snap);
+
+    int mSize_ = 0;
+
+    // - polygon points, with the first one repeated at the end so point i + 1 always exists
+    std::vector<float> mX_;
+    std::vector<float> mY_;
+    // - per edge i -> i + 1 : crossing with the clip line, and 1 / 0 flags telling if
+    // the crossing and the end point are kept
+    std::vector<float> mCrossX_;
+    std::vector<float> mCrossY_;
+    std::vector<int> mCrosses_;
+    std::vector<int> mInside_;
+    // - compaction output, swapped with mX_ / mY_ after every clip line
+    std::vector<float> mOutX_;
+    std::vector<float> mOutY_;
+};
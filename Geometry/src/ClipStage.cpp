@@ -0,0 +1,281 @@
+#include <algorithm>
+#include <cmath>
+
+#include "ClipStage.h"
+
+// - chunks per thread, more of them balance better when some polygons are expensive
+static const int CHUNKS_PER_THREAD = 8;
+
+static void snap_to_grid(Shape& shape)
+{
+    std::vector<float> points = shape.points();
+    for (auto& coordinate : points)
+        coordinate = std::floor(coordinate);
+
+    shape.setContours(std::move(points), shape.contourEnds());
+}
+
+void ClipStage::setGroups(const std::vector<int>& groups)
+{
+    if (groups == mGroups_)
+        return;
+
+    mGroups_ = groups;
+    mGroupsChanged_ = true;
+}
+
+void ClipStage::run(const std::vector<const Shape*>& polygons, const std::vector<const Shape*>& clippers, bool concave, ThreadPool* pool, bool use_grid)
+{
+    // - the grid is only rebuilt when a clipper moved or changed
+    mBoxes_.resize(clippers.size());
+    for (size_t i = 0; i < clippers.size(); i++)
+        mBoxes_[i] = clippers[i]->bounds();
+
+    const bool regridded = use_grid && mGrid_.build(mBoxes_);
+    const bool recounted = clippers.size() != mClipperRevisions_.size();
+
+    // - find the clippers that changed since the previous run
+    mAllDirty_ = mFirstRun_ || concave != mConcave_ || use_grid != mUseGrid_ || mExact_ != mClippedExact_ || mGroupsChanged_;
+    mFirstRun_ = false;
+    mGroupsChanged_ = false;
+    mConcave_ = concave;
+    mUseGrid_ = use_grid;
+    mClippedExact_ = mExact_;
+
+    mStaleClippers_.clear();
+    mNewClippers_.clear();
+
+    std::unordered_map<const Shape*, unsigned long long> revisions;
+    for (size_t i = 0; i < clippers.size(); i++)
+    {
+        revisions[clippers[i]] = clippers[i]->revision();
+
+        const auto previous = mClipperRevisions_.find(clippers[i]);
+        if (previous == mClipperRevisions_.end() || previous->second != clippers[i]->revision())
+            mNewClippers_.push_back(i);
+    }
+
+    for (const auto& previous : mClipperRevisions_)
+    {
+        const auto current = revisions.find(previous.first);
+        if (current == revisions.end() || current->second != previous.second)
+            mStaleClippers_.insert(previous.first);
+    }
+
+    mClipperRevisions_.swap(revisions);
+
+    if (mAllDirty_ || !mNewClippers_.empty() || !mStaleClippers_.empty())
+        find_internal_edges(clippers);
+
+    // - then the polygons to clip again
+    const int count = polygons.size();
+    const bool resized = int(mOutputs_.size()) != count;
+    mOutputs_.resize(count);
+    mDirty_.clear();
+    mScratches_.resize(std::max(int(mScratches_.size()), 1));
+
+    for (int p = 0; p < count; p++)
+    {
+        PolygonOutput& output = mOutputs_[p];
+        if (!is_dirty(output, *polygons[p]))
+        {
+            // - same results, but the pairs going through the broad phase may differ
+            if (regridded)
+            {
+                mGrid_.query(polygons[p]->bounds(), mScratches_[0].candidates);
+                output.tested = mScratches_[0].candidates.size();
+            }
+            else if (recounted && !use_grid)
+                output.tested = clippers.size();
+
+            continue;
+        }
+
+        output.polygon = polygons[p];
+        output.revision = polygons[p]->revision();
+        mDirty_.push_back(p);
+    }
+
+    // - nothing moved, the previous results are still right
+    if (mDirty_.empty() && !resized && !regridded && !recounted)
+        return;
+
+    const int threads = pool == nullptr ? 1 : pool->threads();
+    const int dirty = mDirty_.size();
+    const int grain = std::max(dirty / (threads * CHUNKS_PER_THREAD), 1);
+    mScratches_.resize(std::max(int(mScratches_.size()), threads));
+
+    auto task = [&](int begin, int end, int thread)
+    {
+        for (int i = begin; i < end; i++)
+            clip_polygon(clippers, mDirty_[i], mScratches_[thread]);
+    };
+
+    if (pool == nullptr)
+    {
+        if (dirty > 0)
+            task(0, dirty, 0);
+    }
+    else
+        pool->parallel_for(dirty, grain, task);
+
+    // - polygon order, so the result doesn't depend on which thread ran what
+    mResults_.clear();
+    mTested_ = mClipped_ = 0;
+
+    for (auto& output : mOutputs_)
+    {
+        for (int i = 0; i < output.used; i++)
+            mResults_.push_back(&output.shapes[i]);
+
+        mTested_ += output.tested;
+        mClipped_ += output.clipped.size();
+    }
+}
+
+bool ClipStage::is_dirty(const PolygonOutput& output, const Shape& polygon) const
+{
+    if (mAllDirty_ || output.polygon != &polygon || output.revision != polygon.revision())
+        return true;
+
+    // - a clipper it was touching changed or is gone
+    if (!mStaleClippers_.empty())
+        for (const Shape* clipper : output.clipped)
+            if (mStaleClippers_.count(clipper) != 0)
+                return true;
+
+    // - a new or modified clipper now touches it
+    const BoundingBox polygon_box = polygon.bounds();
+    for (int id : mNewClippers_)
+        if (polygon_box.overlaps(mBoxes_[id]))
+            return true;
+
+    return false;
+}
+
+void ClipStage::clip_polygon(const std::vector<const Shape*>& clippers, int index, Scratch& scratch)
+{
+    auto& candidates = scratch.candidates;
+    scratch.sources.clear();
+
+    PolygonOutput& output = mOutputs_[index];
+    const Shape& polygon = *output.polygon;
+    const BoundingBox polygon_box = polygon.bounds();
+
+    output.used = output.tested = 0;
+    output.clipped.clear();
+
+    if (mUseGrid_)
+        mGrid_.query(polygon_box, candidates);
+    else
+    {
+        candidates.resize(clippers.size());
+        for (size_t i = 0; i < candidates.size(); i++)
+            candidates[i] = i;
+    }
+
+    for (int id : candidates)
+    {
+        output.tested++;
+
+        // - broad phase : nothing to clip if the boxes are disjoint
+        if (!polygon_box.overlaps(mBoxes_[id]))
+            continue;
+
+        output.clipped.push_back(clippers[id]);
+
+        if (output.used == int(output.shapes.size()))
+            output.shapes.emplace_back();
+
+        // - convex clippers never need greiner-hormann. Pieces sharing an edge are
+        // snapped once merged
+        Shape& result = output.shapes[output.used];
+        if (mConcave_ && !clippers[id]->convex())
+            result.greinerHormann(polygon, *clippers[id]);
+        else
+            result.sutherlandOgdmann(polygon, *clippers[id], mClippedExact_, mInternalEdges_[id] == 0);
+
+        // - empty results are not kept, their slot goes to the next pair
+        if (result.size() != 0)
+        {
+            scratch.sources.push_back(id);
+            output.used++;
+        }
+    }
+
+    if (mGroups_.size() == clippers.size())
+        merge_fragments(clippers, output, scratch);
+}
+
+void ClipStage::merge_fragments(const std::vector<const Shape*>& clippers, PolygonOutput& output, Scratch& scratch)
+{
+    // - results come in clipper order, so the fragments of one window follow each other
+    int kept = 0;
+
+    for (int first = 0; first < output.used;)
+    {
+        const int group = mGroups_[scratch.sources[first]];
+        int last = first + 1;
+        while (last < output.used && mGroups_[scratch.sources[last]] == group)
+            last++;
+
+        if (last - first > 1)
+        {
+            scratch.fragments.clear();
+            scratch.pieces.clear();
+            scratch.internal_edges.clear();
+
+            for (int i = first; i < last; i++)
+            {
+                scratch.fragments.push_back(&output.shapes[i]);
+                scratch.pieces.push_back(clippers[scratch.sources[i]]);
+                scratch.internal_edges.push_back(mInternalEdges_[scratch.sources[i]]);
+            }
+
+            if (scratch.merger.merge(scratch.fragments, scratch.pieces, scratch.internal_edges, scratch.merged))
+            {
+                std::swap(output.shapes[kept++], scratch.merged);
+                first = last;
+                continue;
+            }
+        }
+
+        // - a lone fragment, or fragments that couldn't be joined, are kept as they are
+        for (; first < last; first++, kept++)
+        {
+            if (mInternalEdges_[scratch.sources[first]] != 0)
+                snap_to_grid(output.shapes[first]);
+
+            if (first != kept)
+                std::swap(output.shapes[kept], output.shapes[first]);
+        }
+    }
+
+    output.used = kept;
+}
+
+void ClipStage::find_internal_edges(const std::vector<const Shape*>& clippers)
+{
+    mInternalEdges_.assign(clippers.size(), 0);
+    if (mGroups_.size() != clippers.size())
+        return;
+
+    std::vector<const Shape*> pieces;
+    std::vector<unsigned int> edges;
+
+    for (size_t first = 0; first < clippers.size();)
+    {
+        size_t last = first + 1;
+        while (last < clippers.size() && mGroups_[last] == mGroups_[first])
+            last++;
+
+        if (last - first > 1)
+        {
+            pieces.assign(clippers.begin() + first, clippers.begin() + last);
+            FragmentMerger::find_internal_edges(pieces, edges);
+            std::copy(edges.begin(), edges.end(), mInternalEdges_.begin() + first);
+        }
+
+        first = last;
+    }
+}
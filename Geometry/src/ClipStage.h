@@ -0,0 +1,99 @@
+#pragma once
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "FragmentMerger.h"
+#include "Shape.h"
+#include "SpatialGrid.h"
+#include "ThreadPool.h"
+
+// - clips every polygon against every window it can touch. Each polygon keeps its own
+// results between runs and is only clipped again when it changed, or when a window
+// it touches (or now touches) changed. Dirty polygons are split over the threads of
+// a pool, and the results are read back in the single threaded order (polygon, then
+// window) whatever thread computed them
+class ClipStage
+{
+public:
+    // - concave : greiner-hormann against the concave clippers, sutherland-hodgman
+    // against the convex ones. Otherwise every clipper must be convex.
+    // Without pool everything runs on the calling thread, without grid every pair
+    // goes through the bounding box test
+    void run(const std::vector<const Shape*>& polygons, const std::vector<const Shape*>& clippers, bool concave, ThreadPool* pool = nullptr, bool use_grid = true);
+    // - sutherland-hodgman on the integer grid, every result is clipped again when it changes
+    void setExact(bool exact) { mExact_ = exact; }
+    // - group of each clipper of the next runs. Clippers sharing a group are pieces of
+    // one window, next to each other, and a polygon's results against them are merged
+    // into one. Empty when nothing has to be merged
+    void setGroups(const std::vector<int>& groups);
+
+    // - non empty results, in order. A result that was not clipped again keeps its
+    // revision, so it tells what has to be refreshed
+    int size() const { return mResults_.size(); }
+    const Shape& result(int i) const { return *mResults_[i]; }
+    // - pairs going through the bounding box test, and the ones really clipped
+    int tested() const { return mTested_; }
+    int clipped() const { return mClipped_; }
+    // - polygons clipped again by the last run
+    int recomputed() const { return mDirty_.size(); }
+
+private:
+    struct PolygonOutput
+    {
+        const Shape* polygon = nullptr;
+        unsigned long long revision = 0;
+        std::vector<Shape> shapes;
+        int used = 0;
+        int tested = 0;
+        // - clippers whose box overlapped the polygon
+        std::vector<const Shape*> clipped;
+    };
+
+    // - per thread buffers
+    struct Scratch
+    {
+        std::vector<int> candidates;
+        // - clipper of each result
+        std::vector<int> sources;
+        FragmentMerger merger;
+        Shape merged;
+        std::vector<const Shape*> fragments;
+        std::vector<const Shape*> pieces;
+        std::vector<unsigned int> internal_edges;
+    };
+
+    bool is_dirty(const PolygonOutput& output, const Shape& polygon) const;
+    void clip_polygon(const std::vector<const Shape*>& clippers, int index, Scratch& scratch);
+    void merge_fragments(const std::vector<const Shape*>& clippers, PolygonOutput& output, Scratch& scratch);
+    void find_internal_edges(const std::vector<const Shape*>& clippers);
+
+    SpatialGrid mGrid_;
+    std::vector<BoundingBox> mBoxes_;
+    std::vector<PolygonOutput> mOutputs_;
+    std::vector<Shape*> mResults_;
+    int mTested_ = 0;
+    int mClipped_ = 0;
+    bool mExact_ = false;
+    std::vector<int> mGroups_;
+    bool mGroupsChanged_ = false;
+    // - per clipper, bit e is set when its edge e is shared with another piece of its group
+    std::vector<unsigned int> mInternalEdges_;
+
+    // - state of the previous run
+    bool mConcave_ = false;
+    bool mUseGrid_ = true;
+    bool mClippedExact_ = false;
+    bool mFirstRun_ = true;
+    std::unordered_map<const Shape*, unsigned long long> mClipperRevisions_;
+
+    // - clippers changed since the previous run : the ones gone or modified, and the
+    // new or modified ones (as indices in the current list)
+    std::unordered_set<const Shape*> mStaleClippers_;
+    std::vector<int> mNewClippers_;
+    bool mAllDirty_ = false;
+
+    std::vector<int> mDirty_;
+    std::vector<Scratch> mScratches_;
+};
@@ -0,0 +1,206 @@
+#include <algorithm>
+#include <cmath>
+
+#include "CoverageFill.h"
+#include "Shape.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define COVERAGE_FILL_SSE2
+#endif
+
+void CoverageFill::fill(const Shape& shape, CoverageMask& mask)
+{
+    mWidth_ = std::max(mask.width, 0);
+    mHeight_ = std::max(mask.height, 0);
+    mask.coverage.assign(size_t(mWidth_) * mHeight_, 0);
+
+    if (mWidth_ == 0 || mHeight_ == 0 || shape.size() < 3)
+        return;
+
+    mAccumulation_.assign(size_t(stride()) * mHeight_, 0.0f);
+
+    // - in the mask's pixels
+    const auto& points = shape.points();
+    const float dx = -float(mask.x);
+    const float dy = -float(mask.y);
+
+    for (int contour = 0; contour < shape.contours(); contour++)
+    {
+        const int begin = shape.contourBegin(contour);
+        const int end = shape.contourEnd(contour);
+
+        for (int i = begin; i < end; i++)
+        {
+            const int j = i + 1 == end ? begin : i + 1;
+            add_edge(points[i * 2] + dx, points[i * 2 + 1] + dy, points[j * 2] + dx, points[j * 2 + 1] + dy);
+        }
+    }
+
+    accumulate(mask.coverage);
+}
+
+void CoverageFill::add_edge(float x0, float y0, float x1, float y1)
+{
+    const float width = float(mWidth_);
+
+    // - a crossing only counts for the pixels on its left, so moving the parts of an edge
+    // lying left of the mask onto x = 0 (and right of it onto x = width) keeps every
+    // coverage inside. Split where the edge crosses those borders
+    // - the start, up to 2 crossings and the end
+    float cuts[4] = { 0.0f, 1.0f, 1.0f, 1.0f };
+    int count = 1;
+
+    if ((x0 < 0.0f) != (x1 < 0.0f))
+        cuts[count++] = -x0 / (x1 - x0);
+    if ((x0 > width) != (x1 > width))
+        cuts[count++] = (width - x0) / (x1 - x0);
+
+    if (count == 3 && cuts[2] < cuts[1])
+        std::swap(cuts[1], cuts[2]);
+    cuts[count] = 1.0f;
+
+    for (int k = 0; k < count; k++)
+    {
+        const float xa = std::min(std::max(x0 + (x1 - x0) * cuts[k], 0.0f), width);
+        const float ya = y0 + (y1 - y0) * cuts[k];
+        const float xb = std::min(std::max(x0 + (x1 - x0) * cuts[k + 1], 0.0f), width);
+        const float yb = y0 + (y1 - y0) * cuts[k + 1];
+        add_line(xa, ya, xb, yb);
+    }
+}
+
+void CoverageFill::add_line(float x0, float y0, float x1, float y1)
+{
+    if (y0 == y1)
+        return;
+
+    // - from top to bottom, dir keeps the orientation
+    float dir = 1.0f;
+    if (y0 > y1)
+    {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+        dir = -1.0f;
+    }
+
+    const float width = float(mWidth_);
+    const float dxdy = (x1 - x0) / (y1 - y0);
+    const int first = std::max(int(std::floor(y0)), 0);
+    const int last = std::min(int(std::ceil(y1)), mHeight_);
+    float x = x0 + (std::max(y0, 0.0f) - y0) * dxdy;
+
+    for (int y = first; y < last; y++)
+    {
+        float* row = &mAccumulation_[size_t(y) * stride()];
+
+        // - the part of the edge inside this row
+        const float dy = std::min(float(y + 1), y1) - std::max(float(y), y0);
+        const float next = std::min(std::max(x + dxdy * dy, 0.0f), width);
+        const float d = dy * dir;
+
+        const float left = std::min(x, next);
+        const float right = std::max(x, next);
+        const float left_floor = std::floor(left);
+        const int left_pixel = int(left_floor);
+        const int right_pixel = int(std::ceil(right));
+
+        if (right_pixel <= left_pixel + 1)
+        {
+            // - within a pixel : it gets the area right of the edge, the next pixel the rest
+            const float middle = 0.5f * (x + next) - left_floor;
+            row[left_pixel] += d - d * middle;
+            row[left_pixel + 1] += d * middle;
+        }
+        else
+        {
+            // - across several pixels : a triangle in the first and the last one, and
+            // the same slice of the area in every pixel in between
+            const float slope = 1.0f / (right - left);
+            const float left_fraction = left - left_floor;
+            const float first_area = 0.5f * slope * (1.0f - left_fraction) * (1.0f - left_fraction);
+            const float right_fraction = right - float(right_pixel) + 1.0f;
+            const float last_area = 0.5f * slope * right_fraction * right_fraction;
+
+            row[left_pixel] += d * first_area;
+
+            if (right_pixel == left_pixel + 2)
+                row[left_pixel + 1] += d * (1.0f - first_area - last_area);
+            else
+            {
+                const float second_area = slope * (1.5f - left_fraction);
+                row[left_pixel + 1] += d * (second_area - first_area);
+
+                for (int i = left_pixel + 2; i < right_pixel - 1; i++)
+                    row[i] += d * slope;
+
+                const float covered = second_area + float(right_pixel - left_pixel - 3) * slope;
+                row[right_pixel - 1] += d * (1.0f - covered - last_area);
+            }
+
+            row[right_pixel] += d * last_area;
+        }
+
+        x = next;
+    }
+}
+
+void CoverageFill::accumulate(std::vector<unsigned char>& coverage)
+{
+    // - running sum along each row, then |sum| folded for the even-odd rule : 1 and 3
+    // are inside, 0 and 2 outside, and fractions in between. The buffer is emptied for
+    // the next fill
+    for (int y = 0; y < mHeight_; y++)
+    {
+        float* row = &mAccumulation_[size_t(y) * stride()];
+        unsigned char* out = &coverage[size_t(y) * mWidth_];
+        int x = 0;
+        float sum = 0.0f;
+
+#if defined(COVERAGE_FILL_SSE2)
+        const __m128 sign = _mm_set1_ps(-0.0f);
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 two = _mm_set1_ps(2.0f);
+        const __m128 scale = _mm_set1_ps(255.0f);
+        __m128 carry = _mm_setzero_ps();
+
+        for (; x + 4 <= mWidth_; x += 4)
+        {
+            // - prefix sum of 4 values in 2 shifted adds, plus the sum of the previous ones
+            __m128 value = _mm_loadu_ps(row + x);
+            value = _mm_add_ps(value, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(value), 4)));
+            value = _mm_add_ps(value, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(value), 8)));
+            value = _mm_add_ps(value, carry);
+            carry = _mm_shuffle_ps(value, value, _MM_SHUFFLE(3, 3, 3, 3));
+
+            __m128 c = _mm_andnot_ps(sign, value);
+            const __m128 pairs = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_mul_ps(c, half)));
+            c = _mm_sub_ps(c, _mm_mul_ps(pairs, two));
+            c = _mm_min_ps(c, _mm_sub_ps(two, c));
+
+            const __m128i bytes = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(c, scale), half));
+            const __m128i words = _mm_packs_epi32(bytes, bytes);
+            const int packed = _mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+            std::copy(reinterpret_cast<const unsigned char*>(&packed), reinterpret_cast<const unsigned char*>(&packed) + 4, out + x);
+
+            _mm_storeu_ps(row + x, _mm_setzero_ps());
+        }
+
+        sum = _mm_cvtss_f32(carry);
+#endif
+
+        for (; x < mWidth_; x++)
+        {
+            sum += row[x];
+            row[x] = 0.0f;
+
+            float c = std::abs(sum);
+            c -= 2.0f * float(int(c * 0.5f));
+            c = std::min(c, 2.0f - c);
+            out[x] = (unsigned char)(int(c * 255.0f + 0.5f));
+        }
+
+        row[mWidth_] = 0.0f;
+        row[mWidth_ + 1] = 0.0f;
+    }
+}
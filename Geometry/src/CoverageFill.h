@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+
+class Shape;
+
+// - 8 bit coverage of a block of pixels, row after row from the top. 255 is a pixel
+// fully inside, 0 fully outside
+struct CoverageMask
+{
+    // - first pixel in the shape's coordinates (without translation)
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> coverage;
+};
+
+// - anti-aliased fill : the exact area of each pixel covered by the shape. Each edge
+// adds, in the pixels it crosses, the signed area between it and the pixel's right side,
+// and a running sum along each row turns those into coverages (the accumulation
+// font rasterizers use). O(edge length + pixels), no sampling. Overlaps follow the
+// even-odd rule like the scanline fill
+class CoverageFill
+{
+public:
+    // - fills the pixels of the mask, whose position and size are already set
+    void fill(const Shape& shape, CoverageMask& mask);
+
+private:
+    // - stride of a row of mAccumulation_ : a column more for the edges ending on the right border
+    int stride() const { return mWidth_ + 2; }
+    // - the edge split where it leaves [0, width] horizontally, the parts outside moved
+    // onto the border : the coverage inside doesn't change
+    void add_edge(float x0, float y0, float x1, float y1);
+    void add_line(float x0, float y0, float x1, float y1);
+    void accumulate(std::vector<unsigned char>& coverage);
+
+    int mWidth_ = 0;
+    int mHeight_ = 0;
+    std::vector<float> mAccumulation_;
+};
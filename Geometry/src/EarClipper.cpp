@@ -0,0 +1,370 @@
+#include <algorithm>
+
+#include "EarClipper.h"
+
+// - below this many points, walking the ring to test an ear is cheaper than sorting
+// the points along the curve
+static const int HASH_MIN_POINTS = 80;
+
+void EarClipper::triangulate(const float* points, int begin, int end, std::vector<int>& indices)
+{
+    const int count = end - begin;
+    if (count < 3)
+        return;
+
+    mNodes_.resize(count);
+    double sum = 0.0;
+
+    for (int i = 0; i < count; i++)
+    {
+        Node& node = mNodes_[i];
+        node.x = points[(begin + i) * 2];
+        node.y = points[(begin + i) * 2 + 1];
+        node.index = begin + i;
+        node.prev = i == 0 ? count - 1 : i - 1;
+        node.next = i + 1 == count ? 0 : i + 1;
+        node.prev_z = -1;
+        node.next_z = -1;
+        node.z = 0;
+        node.reflex = false;
+
+        const int j = (begin + node.next) * 2;
+        sum += double(node.x) * points[j + 1] - double(points[j]) * node.y;
+    }
+
+    mSign_ = sum < 0.0 ? -1.0 : 1.0;
+    mHashed_ = false;
+
+    int ear = filter(0);
+    if (mNodes_[ear].prev == mNodes_[ear].next)
+        return;
+
+    int node = ear;
+    do
+    {
+        update_reflex(node);
+        node = mNodes_[node].next;
+    } while (node != ear);
+
+    if (count >= HASH_MIN_POINTS)
+        index_curve(ear);
+
+    // - pass 0 looks for ears, 1 for the same after removing flat vertices, 2 after
+    // cutting crossing edges. Past that the ring can't be cut cleanly anymore
+    int stop = ear;
+    int pass = 0;
+
+    while (mNodes_[ear].prev != mNodes_[ear].next)
+    {
+        const int prev = mNodes_[ear].prev;
+        const int next = mNodes_[ear].next;
+
+        if (mHashed_ ? is_ear_hashed(ear) : is_ear(ear))
+        {
+            emit(prev, ear, next, indices);
+            remove(ear);
+            update_reflex(prev);
+            update_reflex(next);
+
+            // - going on past the next vertex gives less slivers
+            ear = mNodes_[next].next;
+            stop = ear;
+            pass = 0;
+            continue;
+        }
+
+        ear = next;
+        if (ear != stop)
+            continue;
+
+        if (pass == 0)
+            ear = filter(ear);
+        else if (pass == 1)
+            ear = cure_intersections(filter(ear), indices);
+        else
+        {
+            // - the first convex vertex is clipped even though the ring crosses it
+            int forced = ear;
+            while (area(mNodes_[forced].prev, forced, mNodes_[forced].next) <= 0.0 && mNodes_[forced].next != ear)
+                forced = mNodes_[forced].next;
+
+            const int a = mNodes_[forced].prev;
+            const int c = mNodes_[forced].next;
+
+            if (area(a, forced, c) > 0.0)
+                emit(a, forced, c, indices);
+
+            remove(forced);
+            update_reflex(a);
+            update_reflex(c);
+            ear = c;
+        }
+
+        stop = ear;
+        pass = (pass + 1) % 3;
+    }
+}
+
+double EarClipper::area(int a, int b, int c) const
+{
+    const Node& p = mNodes_[a];
+    const Node& q = mNodes_[b];
+    const Node& r = mNodes_[c];
+
+    return mSign_ * ((double(q.x) - p.x) * (double(r.y) - p.y) - (double(q.y) - p.y) * (double(r.x) - p.x));
+}
+
+bool EarClipper::equals(int a, int b) const
+{
+    return mNodes_[a].x == mNodes_[b].x && mNodes_[a].y == mNodes_[b].y;
+}
+
+void EarClipper::update_reflex(int node)
+{
+    // - flat vertices count as reflex : they can touch an ear from inside too
+    mNodes_[node].reflex = area(mNodes_[node].prev, node, mNodes_[node].next) <= 0.0;
+}
+
+void EarClipper::remove(int node)
+{
+    const Node& n = mNodes_[node];
+    mNodes_[n.prev].next = n.next;
+    mNodes_[n.next].prev = n.prev;
+
+    if (n.prev_z != -1)
+        mNodes_[n.prev_z].next_z = n.next_z;
+    if (n.next_z != -1)
+        mNodes_[n.next_z].prev_z = n.prev_z;
+}
+
+int EarClipper::filter(int start)
+{
+    int node = start;
+    int end = start;
+    bool again;
+
+    do
+    {
+        again = false;
+        const int next = mNodes_[node].next;
+
+        if (equals(node, next) || area(mNodes_[node].prev, node, next) == 0.0)
+        {
+            const int prev = mNodes_[node].prev;
+            remove(node);
+            node = end = prev;
+
+            if (node == mNodes_[node].next)
+                break;
+
+            update_reflex(prev);
+            update_reflex(next);
+            again = true;
+        }
+        else
+            node = next;
+    } while (again || node != end);
+
+    return end;
+}
+
+void EarClipper::index_curve(int first)
+{
+    mHashed_ = true;
+    mOrder_.clear();
+
+    int node = first;
+    float max_x = mNodes_[first].x;
+    float max_y = mNodes_[first].y;
+    mMinX_ = max_x;
+    mMinY_ = max_y;
+
+    do
+    {
+        mOrder_.push_back(node);
+        mMinX_ = std::min(mMinX_, mNodes_[node].x);
+        mMinY_ = std::min(mMinY_, mNodes_[node].y);
+        max_x = std::max(max_x, mNodes_[node].x);
+        max_y = std::max(max_y, mNodes_[node].y);
+        node = mNodes_[node].next;
+    } while (node != first);
+
+    // - 15 bits per axis over the largest side
+    const float size = std::max(max_x - mMinX_, max_y - mMinY_);
+    mScale_ = size > 0.0f ? 32767.0f / size : 0.0f;
+
+    for (int n : mOrder_)
+        mNodes_[n].z = z_order(mNodes_[n].x, mNodes_[n].y);
+
+    std::sort(mOrder_.begin(), mOrder_.end(), [this](int a, int b)
+    {
+        return mNodes_[a].z < mNodes_[b].z;
+    });
+
+    for (size_t i = 0; i < mOrder_.size(); i++)
+    {
+        mNodes_[mOrder_[i]].prev_z = i == 0 ? -1 : mOrder_[i - 1];
+        mNodes_[mOrder_[i]].next_z = i + 1 == mOrder_.size() ? -1 : mOrder_[i + 1];
+    }
+}
+
+unsigned int EarClipper::z_order(float x, float y) const
+{
+    // - interleaves the bits of both coordinates
+    unsigned int ix = (unsigned int)((x - mMinX_) * mScale_);
+    unsigned int iy = (unsigned int)((y - mMinY_) * mScale_);
+
+    ix = (ix | (ix << 8)) & 0x00FF00FF;
+    ix = (ix | (ix << 4)) & 0x0F0F0F0F;
+    ix = (ix | (ix << 2)) & 0x33333333;
+    ix = (ix | (ix << 1)) & 0x55555555;
+
+    iy = (iy | (iy << 8)) & 0x00FF00FF;
+    iy = (iy | (iy << 4)) & 0x0F0F0F0F;
+    iy = (iy | (iy << 2)) & 0x33333333;
+    iy = (iy | (iy << 1)) & 0x55555555;
+
+    return ix | (iy << 1);
+}
+
+bool EarClipper::in_triangle(int a, int b, int c, int p) const
+{
+    // - borders included
+    return area(a, b, p) >= 0.0 && area(b, c, p) >= 0.0 && area(c, a, p) >= 0.0;
+}
+
+bool EarClipper::is_ear(int ear) const
+{
+    const int a = mNodes_[ear].prev;
+    const int c = mNodes_[ear].next;
+
+    if (mNodes_[ear].reflex)
+        return false;
+
+    for (int p = mNodes_[c].next; p != a; p = mNodes_[p].next)
+        if (mNodes_[p].reflex && in_triangle(a, ear, c, p))
+            return false;
+
+    return true;
+}
+
+bool EarClipper::is_ear_hashed(int ear) const
+{
+    const int a = mNodes_[ear].prev;
+    const int c = mNodes_[ear].next;
+
+    if (mNodes_[ear].reflex)
+        return false;
+
+    // - the points in the triangle's box are between the z of its corners on the curve
+    const Node& na = mNodes_[a];
+    const Node& nb = mNodes_[ear];
+    const Node& nc = mNodes_[c];
+    const unsigned int min_z = z_order(std::min({ na.x, nb.x, nc.x }), std::min({ na.y, nb.y, nc.y }));
+    const unsigned int max_z = z_order(std::max({ na.x, nb.x, nc.x }), std::max({ na.y, nb.y, nc.y }));
+
+    auto blocks = [&](int p)
+    {
+        return p != a && p != c && mNodes_[p].reflex && in_triangle(a, ear, c, p);
+    };
+
+    int p = nb.prev_z;
+    int n = nb.next_z;
+
+    while (p != -1 && mNodes_[p].z >= min_z && n != -1 && mNodes_[n].z <= max_z)
+    {
+        if (blocks(p) || blocks(n))
+            return false;
+
+        p = mNodes_[p].prev_z;
+        n = mNodes_[n].next_z;
+    }
+
+    for (; p != -1 && mNodes_[p].z >= min_z; p = mNodes_[p].prev_z)
+        if (blocks(p))
+            return false;
+
+    for (; n != -1 && mNodes_[n].z <= max_z; n = mNodes_[n].next_z)
+        if (blocks(n))
+            return false;
+
+    return true;
+}
+
+bool EarClipper::intersects(int p1, int q1, int p2, int q2) const
+{
+    auto sign = [](double value)
+    {
+        return value > 0.0 ? 1 : value < 0.0 ? -1 : 0;
+    };
+
+    // - r on the segment p q, knowing the 3 points are aligned
+    auto on_segment = [this](int p, int r, int q)
+    {
+        const Node& np = mNodes_[p];
+        const Node& nq = mNodes_[q];
+        const Node& nr = mNodes_[r];
+        return nr.x <= std::max(np.x, nq.x) && nr.x >= std::min(np.x, nq.x) &&
+               nr.y <= std::max(np.y, nq.y) && nr.y >= std::min(np.y, nq.y);
+    };
+
+    const int o1 = sign(area(p1, q1, p2));
+    const int o2 = sign(area(p1, q1, q2));
+    const int o3 = sign(area(p2, q2, p1));
+    const int o4 = sign(area(p2, q2, q1));
+
+    if (o1 != o2 && o3 != o4)
+        return true;
+
+    return (o1 == 0 && on_segment(p1, p2, q1)) || (o2 == 0 && on_segment(p1, q2, q1)) ||
+           (o3 == 0 && on_segment(p2, p1, q2)) || (o4 == 0 && on_segment(p2, q1, q2));
+}
+
+bool EarClipper::locally_inside(int a, int b) const
+{
+    // - the diagonal a b starts inside the ring at a
+    const int prev = mNodes_[a].prev;
+    const int next = mNodes_[a].next;
+
+    if (area(prev, a, next) > 0.0)
+        return area(a, b, next) <= 0.0 && area(a, prev, b) <= 0.0;
+
+    return area(a, b, prev) > 0.0 || area(a, next, b) > 0.0;
+}
+
+int EarClipper::cure_intersections(int start, std::vector<int>& indices)
+{
+    int p = start;
+
+    do
+    {
+        const int a = mNodes_[p].prev;
+        const int next = mNodes_[p].next;
+        const int b = mNodes_[next].next;
+
+        // - a p next b where a p crosses next b : a p b is inside, p and next go
+        if (!equals(a, b) && intersects(a, p, next, b) && locally_inside(a, b) && locally_inside(b, a))
+        {
+            emit(a, p, b, indices);
+            remove(p);
+            remove(next);
+            update_reflex(a);
+            update_reflex(b);
+
+            p = start = b;
+            if (mNodes_[p].prev == mNodes_[p].next)
+                return p;
+        }
+
+        p = mNodes_[p].next;
+    } while (p != start);
+
+    return filter(p);
+}
+
+void EarClipper::emit(int a, int b, int c, std::vector<int>& indices)
+{
+    indices.push_back(mNodes_[a].index);
+    indices.push_back(mNodes_[b].index);
+    indices.push_back(mNodes_[c].index);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vector>
+
+// - ear clipping on a circular doubly linked list held in an array, the way earcut
+// does it : removing an ear is relinking its neighbours, and each vertex keeps a
+// reflex flag refreshed when a neighbour goes. Only reflex vertices can lie in an ear,
+// and on large rings they are looked for through a second list sorted along a z-order
+// curve, so an ear only visits the vertices close to its box. Either orientation
+// works, and the buffers are reused between calls
+class EarClipper
+{
+public:
+    // - triangulates the ring of points [begin, end) (x, y pairs), pushing the indices
+    // of the 3 points of each triangle. A self intersecting ring is cut where its edges
+    // cross near an ear, and as a last resort its convex vertices are clipped anyway,
+    // so every ring ends up fully triangulated
+    void triangulate(const float* points, int begin, int end, std::vector<int>& indices);
+
+private:
+    struct Node
+    {
+        float x;
+        float y;
+        // - index of the point
+        int index;
+        int prev;
+        int next;
+        // - neighbours along the z-order curve, -1 at its ends
+        int prev_z;
+        int next_z;
+        unsigned int z;
+        bool reflex;
+    };
+
+    // - twice the signed area of a b c, positive when a b c turns like the ring
+    double area(int a, int b, int c) const;
+    bool equals(int a, int b) const;
+    void update_reflex(int node);
+    void remove(int node);
+    // - removes duplicated and flat vertices around the ring from start, returns one left
+    int filter(int start);
+    // - sorts the ring from first along the z-order curve
+    void index_curve(int first);
+    unsigned int z_order(float x, float y) const;
+    bool in_triangle(int a, int b, int c, int p) const;
+    bool is_ear(int ear) const;
+    bool is_ear_hashed(int ear) const;
+    bool intersects(int p1, int q1, int p2, int q2) const;
+    bool locally_inside(int a, int b) const;
+    // - cuts two crossing edges around an ear off as a triangle, returns where to go on
+    int cure_intersections(int start, std::vector<int>& indices);
+    void emit(int a, int b, int c, std::vector<int>& indices);
+
+    std::vector<Node> mNodes_;
+    std::vector<int> mOrder_;
+    // - 1 or -1, so that area() is positive for convex vertices whatever the orientation
+    double mSign_ = 1.0;
+    bool mHashed_ = false;
+    float mMinX_ = 0.0f;
+    float mMinY_ = 0.0f;
+    float mScale_ = 0.0f;
+};
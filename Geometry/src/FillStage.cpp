@@ -0,0 +1,54 @@
+#include <algorithm>
+
+#include "FillStage.h"
+
+// - shapes taller than this are filled in bands over the whole pool
+static const float TALL_ROWS = 512.0f;
+// - chunks per thread, like the clip stage
+static const int CHUNKS_PER_THREAD = 8;
+
+void FillStage::run(const std::vector<const Shape*>& shapes, bool trapezoids, ThreadPool* pool)
+{
+    const int count = shapes.size();
+    mOutputs_.resize(count);
+    mSmall_.clear();
+    mTall_.clear();
+
+    for (int i = 0; i < count; i++)
+    {
+        mOutputs_[i].clear();
+
+        const BoundingBox box = shapes[i]->bounds();
+        if (pool != nullptr && !trapezoids && !box.empty() && box.y_max - box.y_min > TALL_ROWS)
+            mTall_.push_back(i);
+        else
+            mSmall_.push_back(i);
+    }
+
+    // - every small shape on one thread, no lock : each has its own buffer
+    auto task = [&](int begin, int end, int)
+    {
+        for (int k = begin; k < end; k++)
+        {
+            const int i = mSmall_[k];
+            if (trapezoids)
+                shapes[i]->fillTrapezoids(mOutputs_[i]);
+            else
+                shapes[i]->fill_LCA(mOutputs_[i]);
+        }
+    };
+
+    const int small = mSmall_.size();
+
+    if (pool == nullptr)
+    {
+        if (small > 0)
+            task(0, small, 0);
+    }
+    else
+        pool->parallel_for(small, std::max(small / (pool->threads() * CHUNKS_PER_THREAD), 1), task);
+
+    // - the pool can't be used from its own tasks, so the tall shapes come after
+    for (int i : mTall_)
+        shapes[i]->fill_LCA(mOutputs_[i], pool);
+}
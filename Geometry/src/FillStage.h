@@ -0,0 +1,25 @@
+#pragma once
+
+#include <vector>
+
+#include "Shape.h"
+#include "ThreadPool.h"
+
+// - fills a set of shapes at once. Shapes are spread over the threads of a pool, each
+// one filling into its own buffer, and the tall ones are then filled one after the
+// other in bands of rows over the whole pool (see ScanlineFill)
+class FillStage
+{
+public:
+    // - trapezoids fills with fillTrapezoids instead of fill_LCA, those are never split
+    // in bands. Without pool everything runs on the calling thread
+    void run(const std::vector<const Shape*>& shapes, bool trapezoids, ThreadPool* pool = nullptr);
+
+    // - fill of shapes[i] of the last run
+    const std::vector<float>& vertices(int i) const { return mOutputs_[i]; }
+
+private:
+    std::vector<std::vector<float>> mOutputs_;
+    std::vector<int> mSmall_;
+    std::vector<int> mTall_;
+};
@@ -0,0 +1,256 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <map>
+
+#include "FragmentMerger.h"
+
+// - fragments are not snapped, only rounding errors move a point off its edge
+static const float ON_EDGE_DISTANCE = 0.05f;
+// - both sides of a shared edge compute their own crossing
+static const float JOIN_DISTANCE = 0.5f;
+
+static float squared_distance_to_segment(float px, float py, float x1, float y1, float x2, float y2)
+{
+    const float dx = x2 - x1;
+    const float dy = y2 - y1;
+    const float length = dx * dx + dy * dy;
+
+    float t = length > 0.0f ? ((px - x1) * dx + (py - y1) * dy) / length : 0.0f;
+    t = std::min(std::max(t, 0.0f), 1.0f);
+
+    const float ex = x1 + t * dx - px;
+    const float ey = y1 + t * dy - py;
+    return ex * ex + ey * ey;
+}
+
+static bool is_degenerate(const Shape& piece)
+{
+    const auto& points = piece.points();
+    float area = 0.0f;
+
+    for (int i = 0; i < piece.size(); i++)
+    {
+        const int j = (i + 1) % piece.size();
+        area += points[i * 2] * points[j * 2 + 1] - points[j * 2] * points[i * 2 + 1];
+    }
+
+    return area == 0.0f;
+}
+
+void FragmentMerger::find_internal_edges(const std::vector<const Shape*>& pieces, std::vector<unsigned int>& edges)
+{
+    edges.assign(pieces.size(), 0);
+
+    // - translated end points of every edge, then their piece and edge index
+    std::map<std::array<float, 4>, std::pair<int, int>> owners;
+
+    for (size_t i = 0; i < pieces.size(); i++)
+    {
+        const Shape& piece = *pieces[i];
+
+        // - ear clipping may end on a flat triangle, whose edges go back and forth over a
+        // window edge : it shares nothing
+        if (is_degenerate(piece))
+            continue;
+
+        const auto& points = piece.points();
+        const float* tr = piece.translation();
+        const int n = std::min(piece.size(), 32);
+
+        for (int e = 0; e < n; e++)
+        {
+            const int f = (e + 1) % piece.size();
+            const std::array<float, 4> edge = { points[e * 2] + tr[0], points[e * 2 + 1] + tr[1], points[f * 2] + tr[0], points[f * 2 + 1] + tr[1] };
+            const std::array<float, 4> reversed = { edge[2], edge[3], edge[0], edge[1] };
+
+            const auto other = owners.find(reversed);
+            if (other != owners.end())
+            {
+                edges[i] |= 1u << e;
+                edges[other->second.first] |= 1u << other->second.second;
+            }
+            else
+                owners[edge] = { int(i), e };
+        }
+    }
+}
+
+bool FragmentMerger::merge(const std::vector<const Shape*>& fragments, const std::vector<const Shape*>& pieces, const std::vector<unsigned int>& internal_edges, Shape& result)
+{
+    mPoints_.clear();
+    mChains_.clear();
+    mResult_.clear();
+    mContourEnds_.clear();
+
+    for (size_t k = 0; k < fragments.size(); k++)
+        split(*fragments[k], *pieces[k], internal_edges[k]);
+
+    if (!chain())
+        return false;
+
+    result.setContours(mResult_, mContourEnds_);
+    return true;
+}
+
+void FragmentMerger::split(const Shape& fragment, const Shape& piece, unsigned int internal_edges)
+{
+    const auto& points = fragment.points();
+    const int n = fragment.size();
+
+    mInternal_.resize(n);
+    int first = -1;
+
+    for (int i = 0; i < n; i++)
+    {
+        const int j = (i + 1) % n;
+        mInternal_[i] = internal_edges != 0 && on_internal_edge(points[i * 2], points[i * 2 + 1], points[j * 2], points[j * 2 + 1], piece, internal_edges);
+        if (mInternal_[i] && first == -1)
+            first = i;
+    }
+
+    // - nothing shared : the fragment is a contour on its own
+    if (first == -1)
+    {
+        mChains_.push_back({ int(mPoints_.size()), int(mPoints_.size() + points.size()), true, false });
+        mPoints_.insert(mPoints_.end(), points.begin(), points.end());
+        return;
+    }
+
+    // - one chain per run of kept edges, from the end of an internal edge to the start
+    // of the next one
+    for (int k = 1; k <= n; k++)
+    {
+        const int i = (first + k) % n;
+        const int begin = mPoints_.size();
+
+        int last = i;
+        mPoints_.push_back(points[i * 2]);
+        mPoints_.push_back(points[i * 2 + 1]);
+
+        while (!mInternal_[last])
+        {
+            last = (last + 1) % n;
+            mPoints_.push_back(points[last * 2]);
+            mPoints_.push_back(points[last * 2 + 1]);
+            k++;
+        }
+
+        // - a lone point sits between two internal edges, inside the merged shape
+        if (last == i)
+            mPoints_.resize(begin);
+        else
+            mChains_.push_back({ begin, int(mPoints_.size()), false, false });
+    }
+}
+
+bool FragmentMerger::on_internal_edge(float x1, float y1, float x2, float y2, const Shape& piece, unsigned int internal_edges) const
+{
+    const auto& points = piece.points();
+    const float* tr = piece.translation();
+    const float limit = ON_EDGE_DISTANCE * ON_EDGE_DISTANCE;
+
+    for (int e = 0; e < piece.size() && e < 32; e++)
+    {
+        if ((internal_edges & (1u << e)) == 0)
+            continue;
+
+        const int f = (e + 1) % piece.size();
+        const float ax = points[e * 2] + tr[0];
+        const float ay = points[e * 2 + 1] + tr[1];
+        const float bx = points[f * 2] + tr[0];
+        const float by = points[f * 2 + 1] + tr[1];
+
+        // - the middle too : the end points of an edge of a thin piece lie close to
+        // both of its other edges
+        if (squared_distance_to_segment(x1, y1, ax, ay, bx, by) <= limit && squared_distance_to_segment(x2, y2, ax, ay, bx, by) <= limit &&
+            squared_distance_to_segment((x1 + x2) * 0.5f, (y1 + y2) * 0.5f, ax, ay, bx, by) <= limit)
+            return true;
+    }
+
+    return false;
+}
+
+void FragmentMerger::push_point(float x, float y, size_t contour_begin)
+{
+    // - snap to the pixel grid, and skip a point landing on the previous one
+    x = std::floor(x);
+    y = std::floor(y);
+
+    const size_t size = mResult_.size();
+    if (size > contour_begin && mResult_[size - 2] == x && mResult_[size - 1] == y)
+        return;
+
+    mResult_.push_back(x);
+    mResult_.push_back(y);
+}
+
+bool FragmentMerger::chain()
+{
+    const float limit = JOIN_DISTANCE * JOIN_DISTANCE;
+
+    for (size_t c = 0; c < mChains_.size(); c++)
+    {
+        Chain& start = mChains_[c];
+        if (start.used)
+            continue;
+
+        start.used = true;
+
+        const size_t contour_begin = mResult_.size();
+        int current = c;
+
+        for (;;)
+        {
+            const Chain& chain = mChains_[current];
+            for (int i = chain.begin; i < chain.end; i += 2)
+                push_point(mPoints_[i], mPoints_[i + 1], contour_begin);
+
+            if (chain.closed)
+                break;
+
+            // - next chain : the closest start to this end, the first chain closes the contour
+            const float x = mPoints_[chain.end - 2];
+            const float y = mPoints_[chain.end - 1];
+            int next = -1;
+            float best = limit;
+
+            for (size_t k = 0; k < mChains_.size(); k++)
+            {
+                const Chain& other = mChains_[k];
+                if (other.closed || (other.used && k != c))
+                    continue;
+
+                const float dx = mPoints_[other.begin] - x;
+                const float dy = mPoints_[other.begin + 1] - y;
+                const float distance = dx * dx + dy * dy;
+                if (distance <= best)
+                {
+                    best = distance;
+                    next = k;
+                }
+            }
+
+            if (next == -1)
+                return false;
+
+            if (next == int(c))
+                break;
+
+            mChains_[next].used = true;
+            current = next;
+        }
+
+        // - the first point may also close onto the last one
+        const size_t size = mResult_.size();
+        if (size - contour_begin > 2 && mResult_[size - 2] == mResult_[contour_begin] && mResult_[size - 1] == mResult_[contour_begin + 1])
+            mResult_.resize(size - 2);
+
+        if (mResult_.size() - contour_begin < 6)
+            mResult_.resize(contour_begin);
+        else
+            mContourEnds_.push_back(mResult_.size() / 2);
+    }
+
+    return !mResult_.empty();
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+
+#include "Shape.h"
+
+// - joins the fragments of one polygon clipped against each piece (triangle) of one
+// window back into a single shape. Fragment edges lying on an edge shared by two
+// pieces are dropped, and what is left is chained end to start. Fragments must not be
+// snapped to the pixel grid, the merged shape is. Each side of a shared edge computes
+// its own crossings, so ends are matched with a small tolerance
+class FragmentMerger
+{
+public:
+    // - bit e of edges[i] is set when edge e -> e + 1 of pieces[i] is shared (reversed)
+    // with another piece. Only the first 32 edges of a piece are looked at
+    static void find_internal_edges(const std::vector<const Shape*>& pieces, std::vector<unsigned int>& edges);
+
+    // - fragments[k] was clipped against pieces[k], internal_edges[k] are the shared
+    // edges of that piece. Returns false, and leaves result untouched, if the
+    // fragments can't be chained into closed contours
+    bool merge(const std::vector<const Shape*>& fragments, const std::vector<const Shape*>& pieces, const std::vector<unsigned int>& internal_edges, Shape& result);
+
+private:
+    // - points mPoints_[begin] .. mPoints_[end] (x, y pairs, end excluded)
+    struct Chain
+    {
+        int begin;
+        int end;
+        // - a whole fragment, nothing to join
+        bool closed;
+        bool used;
+    };
+
+    void split(const Shape& fragment, const Shape& piece, unsigned int internal_edges);
+    bool on_internal_edge(float x1, float y1, float x2, float y2, const Shape& piece, unsigned int internal_edges) const;
+    bool chain();
+    void push_point(float x, float y, size_t contour_begin);
+
+    std::vector<float> mPoints_;
+    std::vector<Chain> mChains_;
+    std::vector<char> mInternal_;
+    std::vector<float> mResult_;
+    std::vector<int> mContourEnds_;
+};
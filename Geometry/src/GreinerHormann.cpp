@@ -0,0 +1,256 @@
+#include <algorithm>
+
+#include "GreinerHormann.h"
+
+// - crossings closer than this (in edge parameter) to a vertex are degenerate
+static const double EPSILON = 1e-9;
+// - window offset used to get rid of degenerate crossings, small enough to vanish once
+// the result is snapped to the pixel grid
+static const double PERTURBATION_X = 1.3e-3;
+static const double PERTURBATION_Y = 0.7e-3;
+static const int MAX_PERTURBATIONS = 4;
+
+void GreinerHormann::clip(const std::vector<double>& subject, const std::vector<double>& window, std::vector<float>& points, std::vector<int>& contour_ends)
+{
+    // - can't clip a point or a line
+    if (subject.size() < 6 || window.size() < 6)
+        return;
+
+    // - a vertex lying on the other polygon (or two overlapping edges) breaks the
+    // entry / exit alternation, move the window a little until it doesn't happen anymore
+    std::vector<double> moved = window;
+    bool clean = find_intersections(subject, moved);
+
+    for (int attempt = 1; !clean && attempt <= MAX_PERTURBATIONS; attempt++)
+    {
+        for (size_t i = 0; i < moved.size(); i += 2)
+        {
+            moved[i] = window[i] + attempt * PERTURBATION_X;
+            moved[i + 1] = window[i + 1] + attempt * PERTURBATION_Y;
+        }
+
+        clean = find_intersections(subject, moved);
+    }
+
+    // - no crossing : one polygon contains the other or they are disjoint
+    if (mIntersections_.empty())
+    {
+        if (contains(moved, subject[0], subject[1]))
+            add_ring(subject, points, contour_ends);
+        else if (contains(subject, moved[0], moved[1]))
+            add_ring(window, points, contour_ends);
+
+        return;
+    }
+
+    const size_t count = mIntersections_.size() / 2;
+    mSubjectNodes_.resize(count);
+    mWindowNodes_.resize(count);
+
+    build_list(subject, mSubjectCrossings_, mSubject_, true);
+    build_list(moved, mWindowCrossings_, mWindow_, false);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        mSubject_[mSubjectNodes_[i]].neighbor = mWindowNodes_[i];
+        mWindow_[mWindowNodes_[i]].neighbor = mSubjectNodes_[i];
+    }
+
+    mark_entries(mSubject_, moved);
+    mark_entries(mWindow_, subject);
+
+    trace(points, contour_ends);
+}
+
+bool GreinerHormann::find_intersections(const std::vector<double>& subject, const std::vector<double>& window)
+{
+    const int n = subject.size() / 2;
+    const int m = window.size() / 2;
+    bool clean = true;
+
+    mIntersections_.clear();
+    mSubjectCrossings_.resize(n);
+    mWindowCrossings_.resize(m);
+    for (auto& crossings : mSubjectCrossings_)
+        crossings.clear();
+    for (auto& crossings : mWindowCrossings_)
+        crossings.clear();
+
+    for (int i = 0; i < n; i++)
+    {
+        const int i_next = (i + 1) % n;
+        const double px = subject[i * 2];
+        const double py = subject[i * 2 + 1];
+        const double dpx = subject[i_next * 2] - px;
+        const double dpy = subject[i_next * 2 + 1] - py;
+
+        for (int j = 0; j < m; j++)
+        {
+            const int j_next = (j + 1) % m;
+            const double ex = window[j * 2] - px;
+            const double ey = window[j * 2 + 1] - py;
+            const double dqx = window[j_next * 2] - window[j * 2];
+            const double dqy = window[j_next * 2 + 1] - window[j * 2 + 1];
+
+            const double den = dpx * dqy - dpy * dqx;
+
+            // - parallel edges only matter when they overlap
+            if (den == 0.0)
+            {
+                const double length = dpx * dpx + dpy * dpy;
+                if (ex * dpy - ey * dpx != 0.0 || length == 0.0)
+                    continue;
+
+                const double t0 = (ex * dpx + ey * dpy) / length;
+                const double t1 = ((ex + dqx) * dpx + (ey + dqy) * dpy) / length;
+                if (std::max(t0, t1) >= 0.0 && std::min(t0, t1) <= 1.0)
+                    clean = false;
+
+                continue;
+            }
+
+            // - P + alpha * dP = Q + beta * dQ
+            const double alpha = (ex * dqy - ey * dqx) / den;
+            const double beta = (ex * dpy - ey * dpx) / den;
+
+            if (alpha < -EPSILON || alpha > 1.0 + EPSILON || beta < -EPSILON || beta > 1.0 + EPSILON)
+                continue;
+
+            // - crossing on a vertex
+            if (alpha <= EPSILON || alpha >= 1.0 - EPSILON || beta <= EPSILON || beta >= 1.0 - EPSILON)
+            {
+                clean = false;
+                continue;
+            }
+
+            const int id = mIntersections_.size() / 2;
+            mIntersections_.push_back(px + alpha * dpx);
+            mIntersections_.push_back(py + alpha * dpy);
+            mSubjectCrossings_[i].push_back({ alpha, id });
+            mWindowCrossings_[j].push_back({ beta, id });
+        }
+    }
+
+    return clean;
+}
+
+void GreinerHormann::build_list(const std::vector<double>& ring, std::vector<std::vector<Crossing>>& crossings, std::vector<Node>& list, bool subject)
+{
+    const int n = ring.size() / 2;
+    std::vector<int>& nodes = subject ? mSubjectNodes_ : mWindowNodes_;
+
+    list.clear();
+    for (int i = 0; i < n; i++)
+    {
+        list.push_back({ ring[i * 2], ring[i * 2 + 1], 0.0, 0, 0, -1, false, false, false });
+
+        // - crossings are inserted in the order they are met along the edge
+        auto& edge_crossings = crossings[i];
+        std::sort(edge_crossings.begin(), edge_crossings.end(), [](const Crossing& lhs, const Crossing& rhs)
+        {
+            return lhs.alpha < rhs.alpha;
+        });
+
+        for (const auto& crossing : edge_crossings)
+        {
+            list.push_back({ mIntersections_[crossing.id * 2], mIntersections_[crossing.id * 2 + 1], crossing.alpha, 0, 0, -1, true, false, false });
+            nodes[crossing.id] = list.size() - 1;
+        }
+    }
+
+    const int size = list.size();
+    for (int i = 0; i < size; i++)
+    {
+        list[i].next = (i + 1) % size;
+        list[i].prev = (i + size - 1) % size;
+    }
+}
+
+void GreinerHormann::mark_entries(std::vector<Node>& list, const std::vector<double>& other) const
+{
+    // - the first node is always a vertex, crossings then alternate between entry and exit
+    bool inside = contains(other, list[0].x, list[0].y);
+
+    for (auto& node : list)
+    {
+        if (!node.intersect)
+            continue;
+
+        node.entry = !inside;
+        inside = !inside;
+    }
+}
+
+void GreinerHormann::trace(std::vector<float>& points, std::vector<int>& contour_ends)
+{
+    for (size_t start = 0; start < mSubject_.size(); start++)
+    {
+        if (!mSubject_[start].intersect || mSubject_[start].visited)
+            continue;
+
+        const size_t first = points.size();
+        std::vector<Node>* list = &mSubject_;
+        std::vector<Node>* other = &mWindow_;
+        int current = start;
+
+        do
+        {
+            Node& node = (*list)[current];
+            node.visited = true;
+            (*other)[node.neighbor].visited = true;
+
+            const bool forward = node.entry;
+            points.push_back(float(node.x));
+            points.push_back(float(node.y));
+
+            // - walk inside the other polygon until the next crossing
+            do
+            {
+                current = forward ? (*list)[current].next : (*list)[current].prev;
+
+                if (!(*list)[current].intersect)
+                {
+                    points.push_back(float((*list)[current].x));
+                    points.push_back(float((*list)[current].y));
+                }
+            } while (!(*list)[current].intersect);
+
+            // - continue on the other polygon
+            current = (*list)[current].neighbor;
+            std::swap(list, other);
+        } while (!(*list)[current].visited);
+
+        if (points.size() - first >= 6)
+            contour_ends.push_back(points.size() / 2);
+        else
+            points.resize(first);
+    }
+}
+
+void GreinerHormann::add_ring(const std::vector<double>& ring, std::vector<float>& points, std::vector<int>& contour_ends) const
+{
+    for (auto coordinate : ring)
+        points.push_back(float(coordinate));
+
+    contour_ends.push_back(points.size() / 2);
+}
+
+bool GreinerHormann::contains(const std::vector<double>& ring, double x, double y) const
+{
+    // - even-odd rule
+    const int n = ring.size() / 2;
+    bool inside = false;
+
+    for (int i = 0, j = n - 1; i < n; j = i++)
+    {
+        const double xi = ring[i * 2];
+        const double yi = ring[i * 2 + 1];
+        const double xj = ring[j * 2];
+        const double yj = ring[j * 2 + 1];
+
+        if ((yi > y) != (yj > y) && x < (xj - xi) * (y - yi) / (yj - yi) + xi)
+            inside = !inside;
+    }
+
+    return inside;
+}
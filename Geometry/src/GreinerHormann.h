@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+
+// - polygon / polygon intersection (Greiner-Hormann). Unlike sutherland-hodgman the
+// window can be concave, so the result can be made of several contours
+class GreinerHormann
+{
+public:
+    // - subject and window are x, y arrays. Result points are appended to points and
+    // the end index (in points) of each contour to contour_ends
+    void clip(const std::vector<double>& subject, const std::vector<double>& window, std::vector<float>& points, std::vector<int>& contour_ends);
+
+private:
+    struct Node
+    {
+        double x;
+        double y;
+        double alpha;
+        int next;
+        int prev;
+        int neighbor;
+        bool intersect;
+        bool entry;
+        bool visited;
+    };
+
+    struct Crossing
+    {
+        double alpha;
+        int id;
+    };
+
+    bool find_intersections(const std::vector<double>& subject, const std::vector<double>& window);
+    void build_list(const std::vector<double>& ring, std::vector<std::vector<Crossing>>& crossings, std::vector<Node>& list, bool subject);
+    void mark_entries(std::vector<Node>& list, const std::vector<double>& other) const;
+    void trace(std::vector<float>& points, std::vector<int>& contour_ends);
+    void add_ring(const std::vector<double>& ring, std::vector<float>& points, std::vector<int>& contour_ends) const;
+    bool contains(const std::vector<double>& ring, double x, double y) const;
+
+    std::vector<Node> mSubject_;
+    std::vector<Node> mWindow_;
+    std::vector<std::vector<Crossing>> mSubjectCrossings_;
+    std::vector<std::vector<Crossing>> mWindowCrossings_;
+    // - intersection points, then their node index in each list
+    std::vector<double> mIntersections_;
+    std::vector<int> mSubjectNodes_;
+    std::vector<int> mWindowNodes_;
+};
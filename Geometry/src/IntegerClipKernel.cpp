@@ -0,0 +1,149 @@
+#include <cmath>
+#include <algorithm>
+
+#include "IntegerClipKernel.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define INTEGER_CLIP_KERNEL_AVX2
+#endif
+
+// - rounds n / d toward minus infinity, like floor on the float path
+static long long floor_div(long long n, long long d)
+{
+    long long q = n / d;
+    if (n % d != 0 && (n < 0) != (d < 0))
+        q--;
+
+    return q;
+}
+
+bool IntegerClipKernel::snap(float value, int& snapped)
+{
+    const float floored = std::floor(value);
+    if (!(floored > -MAX_COORDINATE && floored < MAX_COORDINATE))
+        return false;
+
+    snapped = int(floored);
+    return true;
+}
+
+bool IntegerClipKernel::load(const float* points, int count, float tx, float ty)
+{
+    reserve(count);
+    mSize_ = 0;
+
+    for (int i = 0; i < count; i++)
+        if (!snap(points[i * 2] + tx, mX_[i]) || !snap(points[i * 2 + 1] + ty, mY_[i]))
+            return false;
+
+    mSize_ = count;
+    return true;
+}
+
+void IntegerClipKernel::clip(int x1, int y1, int x2, int y2)
+{
+    if (mSize_ == 0)
+        return;
+
+    reserve(mSize_);
+    mX_[mSize_] = mX_[0];
+    mY_[mSize_] = mY_[0];
+
+    classify(x1, y1, x2, y2);
+    compact();
+}
+
+void IntegerClipKernel::store(std::vector<float>& points) const
+{
+    points.resize(mSize_ * 2);
+
+    for (int i = 0; i < mSize_; i++)
+    {
+        points[i * 2] = float(mX_[i]);
+        points[i * 2 + 1] = float(mY_[i]);
+    }
+}
+
+void IntegerClipKernel::reserve(int count)
+{
+    // - a clip line can at most double the number of points, plus the repeated first
+    // point and room for a full vector past the end
+    const size_t capacity = count * 2 + 5;
+    if (mX_.size() >= capacity)
+        return;
+
+    mX_.resize(capacity);
+    mY_.resize(capacity);
+    mSides_.resize(capacity);
+    mOutX_.resize(capacity);
+    mOutY_.resize(capacity);
+}
+
+void IntegerClipKernel::classify(int x1, int y1, int x2, int y2)
+{
+    const int n = mSize_;
+    const int* x = mX_.data();
+    const int* y = mY_.data();
+
+    // - differences fit in 32 bits, their products need 64
+    const long long dx = x2 - x1;
+    const long long dy = y2 - y1;
+
+    int i = 0;
+
+#if defined(INTEGER_CLIP_KERNEL_AVX2)
+    const __m256i v_x1 = _mm256_set1_epi64x(x1);
+    const __m256i v_y1 = _mm256_set1_epi64x(y1);
+    const __m256i v_dx = _mm256_set1_epi64x(dx);
+    const __m256i v_dy = _mm256_set1_epi64x(dy);
+
+    // - 4 points per pass, widened to 64 bit lanes. _mm256_mul_epi32 multiplies the
+    // signed low halves of the lanes, which hold the whole differences
+    for (; i + 4 <= n + 1; i += 4)
+    {
+        const __m256i xi = _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i)));
+        const __m256i yi = _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y + i)));
+        const __m256i side = _mm256_sub_epi64(_mm256_mul_epi32(v_dx, _mm256_sub_epi64(yi, v_y1)), _mm256_mul_epi32(v_dy, _mm256_sub_epi64(xi, v_x1)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&mSides_[i]), side);
+    }
+#endif
+
+    for (; i <= n; i++)
+        mSides_[i] = dx * (y[i] - y1) - dy * (x[i] - x1);
+}
+
+void IntegerClipKernel::compact()
+{
+    const int n = mSize_;
+    const long long* sides = mSides_.data();
+    int* out_x = mOutX_.data();
+    int* out_y = mOutY_.data();
+    int count = 0;
+
+    // - edge i -> j gives its crossing if it has one, then j if it is inside
+    for (int i = 0; i < n; i++)
+    {
+        const int j = i + 1;
+        const bool inside_i = sides[i] < 0;
+        const bool inside_j = sides[j] < 0;
+
+        if (inside_i != inside_j)
+        {
+            // - (xj * si - xi * sj) / (si - sj) : swapping i and j negates both terms,
+            // so a shared edge gives the same crossing from both of its polygons
+            const long long den = sides[i] - sides[j];
+            out_x[count] = int(floor_div(mX_[j] * sides[i] - mX_[i] * sides[j], den));
+            out_y[count] = int(floor_div(mY_[j] * sides[i] - mY_[i] * sides[j], den));
+            count++;
+        }
+
+        out_x[count] = mX_[j];
+        out_y[count] = mY_[j];
+        count += inside_j;
+    }
+
+    std::swap(mX_, mOutX_);
+    std::swap(mY_, mOutY_);
+    mSize_ = count;
+}
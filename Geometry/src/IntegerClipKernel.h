@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+
+// - sutherland-hodgman clipping on the integer grid. Side tests are exact int64
+// orientations and every crossing is the floor of its exact rational value, computed
+// the same way whatever the direction of the edge, so two polygons sharing an edge
+// get the same points on it. Side tests are vectorized with AVX2 when the build
+// targets it, crossings are only computed for the edges really crossing the clip line
+class IntegerClipKernel
+{
+public:
+    // - coordinates must stay below this (in absolute value) so every product of the
+    // crossings fits in an int64
+    static const int MAX_COORDINATE = 1 << 19;
+
+    // - snaps a coordinate to the grid, returns false if it is out of range
+    static bool snap(float value, int& snapped);
+
+    // - interleaved x, y points of the polygon to clip, translated then snapped to the
+    // grid. Returns false if a point is out of range
+    bool load(const float* points, int count, float tx, float ty);
+    // - keep the part of the polygon on the inner side of (x1, y1) (x2, y2)
+    void clip(int x1, int y1, int x2, int y2);
+    // - interleaved x, y points of the result
+    void store(std::vector<float>& points) const;
+    int size() const { return mSize_; }
+
+private:
+    void reserve(int count);
+    void classify(int x1, int y1, int x2, int y2);
+    void compact();
+
+    int mSize_ = 0;
+
+    // - polygon points, with the first one repeated at the end so point i + 1 always exists
+    std::vector<int> mX_;
+    std::vector<int> mY_;
+    // - orientation of every point against the clip line, negative inside
+    std::vector<long long> mSides_;
+    // - compaction output, swapped with mX_ / mY_ after every clip line
+    std::vector<int> mOutX_;
+    std::vector<int> mOutY_;
+};
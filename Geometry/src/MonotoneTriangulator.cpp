@@ -0,0 +1,502 @@
+#include <algorithm>
+#include <set>
+
+#include "MonotoneTriangulator.h"
+
+bool MonotoneTriangulator::triangulate(const float* points, int begin, int end, std::vector<int>& indices)
+{
+    load(points, begin, end);
+
+    const int count = mPoints_.size();
+    if (count < 3)
+        return true;
+
+    const size_t size = indices.size();
+    classify();
+
+    if (!add_diagonals() || !split_pieces(indices) || int(indices.size() - size) != (count - 2) * 3)
+    {
+        indices.resize(size);
+        return false;
+    }
+
+    return true;
+}
+
+void MonotoneTriangulator::load(const float* points, int begin, int end)
+{
+    mPoints_.clear();
+
+    auto flat = [](const Point& a, const Point& b, const Point& c)
+    {
+        return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x) == 0.0;
+    };
+
+    // - a point aligned with the 2 kept before it replaces the last one
+    for (int i = begin; i < end; i++)
+    {
+        const Point point{ points[i * 2], points[i * 2 + 1], i };
+
+        if (!mPoints_.empty() && mPoints_.back().x == point.x && mPoints_.back().y == point.y)
+            continue;
+
+        while (mPoints_.size() >= 2 && flat(mPoints_[mPoints_.size() - 2], mPoints_.back(), point))
+            mPoints_.pop_back();
+
+        mPoints_.push_back(point);
+    }
+
+    // - then the same around the place where the ring closes
+    size_t first = 0;
+    bool again = true;
+
+    while (again && mPoints_.size() - first >= 3)
+    {
+        again = false;
+        const Point& a = mPoints_[mPoints_.size() - 2];
+        const Point& b = mPoints_.back();
+        const Point& c = mPoints_[first];
+        const Point& d = mPoints_[first + 1];
+
+        if ((b.x == c.x && b.y == c.y) || flat(a, b, c))
+        {
+            mPoints_.pop_back();
+            again = true;
+        }
+        else if (flat(b, c, d))
+        {
+            first++;
+            again = true;
+        }
+    }
+
+    mPoints_.erase(mPoints_.begin(), mPoints_.begin() + first);
+
+    if (mPoints_.size() < 3)
+    {
+        mPoints_.clear();
+        return;
+    }
+
+    double sum = 0.0;
+    for (size_t i = 0; i < mPoints_.size(); i++)
+    {
+        const Point& a = mPoints_[i];
+        const Point& b = mPoints_[i + 1 == mPoints_.size() ? 0 : i + 1];
+        sum += a.x * b.y - b.x * a.y;
+    }
+
+    mReversed_ = sum < 0.0;
+    if (mReversed_)
+        std::reverse(mPoints_.begin(), mPoints_.end());
+}
+
+bool MonotoneTriangulator::above(int a, int b) const
+{
+    const Point& p = mPoints_[a];
+    const Point& q = mPoints_[b];
+
+    return p.y > q.y || (p.y == q.y && p.x < q.x);
+}
+
+double MonotoneTriangulator::area(int a, int b, int c) const
+{
+    const Point& p = mPoints_[a];
+    const Point& q = mPoints_[b];
+    const Point& r = mPoints_[c];
+
+    return (q.x - p.x) * (r.y - p.y) - (q.y - p.y) * (r.x - p.x);
+}
+
+void MonotoneTriangulator::classify()
+{
+    const int count = mPoints_.size();
+    mTypes_.resize(count);
+
+    for (int i = 0; i < count; i++)
+    {
+        const bool prev_below = above(i, prev(i));
+        const bool next_below = above(i, next(i));
+        const bool convex = area(prev(i), i, next(i)) > 0.0;
+
+        if (prev_below && next_below)
+            mTypes_[i] = convex ? Type::Start : Type::Split;
+        else if (!prev_below && !next_below)
+            mTypes_[i] = convex ? Type::End : Type::Merge;
+        else
+            mTypes_[i] = Type::Regular;
+    }
+
+    mEvents_.resize(count);
+    for (int i = 0; i < count; i++)
+        mEvents_[i] = i;
+
+    std::sort(mEvents_.begin(), mEvents_.end(), [this](int a, int b)
+    {
+        return above(a, b);
+    });
+}
+
+int MonotoneTriangulator::upper(int edge) const
+{
+    return above(edge, next(edge)) ? edge : next(edge);
+}
+
+int MonotoneTriangulator::lower(int edge) const
+{
+    return above(edge, next(edge)) ? next(edge) : edge;
+}
+
+bool MonotoneTriangulator::left_of(int edge, int point) const
+{
+    // - walking down the edge, the point is on the left (east) side
+    return area(upper(edge), lower(edge), point) > 0.0;
+}
+
+bool MonotoneTriangulator::right_of(int edge, int point) const
+{
+    return area(upper(edge), lower(edge), point) < 0.0;
+}
+
+bool MonotoneTriangulator::edge_before(int a, int b) const
+{
+    if (a == b)
+        return false;
+
+    // - the edge starting lower has its top between the ends of the other one
+    const int top_a = upper(a);
+    const int top_b = upper(b);
+
+    if (above(top_b, top_a))
+        return top_a == lower(b) ? right_of(b, lower(a)) : right_of(b, top_a);
+
+    return top_b == lower(a) ? left_of(a, lower(b)) : left_of(a, top_b);
+}
+
+bool MonotoneTriangulator::add_diagonals()
+{
+    const int count = mPoints_.size();
+    mHelpers_.assign(count, -1);
+    mDiagonals_.clear();
+
+    std::set<int, StatusOrder> status(StatusOrder{ this });
+
+    // - the edge directly left of a point, -1 if there is none
+    auto left_edge = [&](int point)
+    {
+        auto it = status.lower_bound(Probe{ point });
+        return it == status.begin() ? -1 : *std::prev(it);
+    };
+
+    auto connect_merge = [&](int point, int edge)
+    {
+        const int helper = mHelpers_[edge];
+        if (helper != -1 && mTypes_[helper] == Type::Merge)
+        {
+            mDiagonals_.push_back(point);
+            mDiagonals_.push_back(helper);
+        }
+    };
+
+    for (int v : mEvents_)
+    {
+        const int e = v;
+        const int p = prev(v);
+
+        switch (mTypes_[v])
+        {
+        case Type::Start:
+            status.insert(e);
+            mHelpers_[e] = v;
+            break;
+
+        case Type::End:
+            connect_merge(v, p);
+            status.erase(p);
+            break;
+
+        case Type::Split:
+        {
+            const int left = left_edge(v);
+            if (left == -1)
+                return false;
+
+            mDiagonals_.push_back(v);
+            mDiagonals_.push_back(mHelpers_[left]);
+            mHelpers_[left] = v;
+            status.insert(e);
+            mHelpers_[e] = v;
+            break;
+        }
+
+        case Type::Merge:
+        {
+            connect_merge(v, p);
+            status.erase(p);
+
+            const int left = left_edge(v);
+            if (left == -1)
+                return false;
+
+            connect_merge(v, left);
+            mHelpers_[left] = v;
+            break;
+        }
+
+        case Type::Regular:
+            // - the inside is on the right when the ring goes down here
+            if (above(p, v))
+            {
+                connect_merge(v, p);
+                status.erase(p);
+                status.insert(e);
+                mHelpers_[e] = v;
+            }
+            else
+            {
+                const int left = left_edge(v);
+                if (left == -1)
+                    return false;
+
+                connect_merge(v, left);
+                mHelpers_[left] = v;
+            }
+            break;
+        }
+    }
+
+    return status.empty();
+}
+
+bool MonotoneTriangulator::split_pieces(std::vector<int>& indices)
+{
+    const int count = mPoints_.size();
+
+    // - neighbours of each point : its 2 edges and its diagonals
+    mNeighbourStarts_.assign(count + 1, 2);
+    mNeighbourStarts_[count] = 0;
+    for (int d : mDiagonals_)
+        mNeighbourStarts_[d]++;
+
+    int total = 0;
+    for (int i = 0; i <= count; i++)
+    {
+        const int degree = mNeighbourStarts_[i];
+        mNeighbourStarts_[i] = total;
+        total += degree;
+    }
+
+    mNeighbours_.resize(total);
+    mWalked_.assign(total, 0);
+
+    for (int i = 0; i < count; i++)
+    {
+        mNeighbours_[mNeighbourStarts_[i]] = prev(i);
+        mNeighbours_[mNeighbourStarts_[i] + 1] = next(i);
+    }
+
+    // - the stack is free until the pieces are triangulated
+    std::vector<int>& fill = mStack_;
+    fill.assign(count, 2);
+    for (size_t i = 0; i < mDiagonals_.size(); i += 2)
+    {
+        const int a = mDiagonals_[i];
+        const int b = mDiagonals_[i + 1];
+        mNeighbours_[mNeighbourStarts_[a] + fill[a]++] = b;
+        mNeighbours_[mNeighbourStarts_[b] + fill[b]++] = a;
+    }
+
+    // - counter clockwise around the point, only the points with diagonals need sorting
+    for (int i = 0; i < count; i++)
+    {
+        int* begin = &mNeighbours_[mNeighbourStarts_[i]];
+        int* end = &mNeighbours_[mNeighbourStarts_[i + 1]];
+        if (end - begin <= 2)
+            continue;
+
+        const Point& center = mPoints_[i];
+        std::sort(begin, end, [&](int a, int b)
+        {
+            const double ax = mPoints_[a].x - center.x;
+            const double ay = mPoints_[a].y - center.y;
+            const double bx = mPoints_[b].x - center.x;
+            const double by = mPoints_[b].y - center.y;
+            const bool lower_a = ay < 0.0 || (ay == 0.0 && ax > 0.0);
+            const bool lower_b = by < 0.0 || (by == 0.0 && bx > 0.0);
+
+            if (lower_a != lower_b)
+                return !lower_a;
+
+            return ax * by - ay * bx > 0.0;
+        });
+    }
+
+    auto slot = [this](int from, int to)
+    {
+        int s = mNeighbourStarts_[from];
+        while (mNeighbours_[s] != to)
+            s++;
+        return s;
+    };
+
+    // - from a side u -> v, the face on its left goes on with the neighbour of v found
+    // just before u turning counter clockwise around v
+    for (int start = 0; start < count; start++)
+    {
+        for (int s = mNeighbourStarts_[start]; s < mNeighbourStarts_[start + 1]; s++)
+        {
+            // - the ring's own edges backward have the outside on their left
+            if (mWalked_[s] || mNeighbours_[s] == prev(start))
+                continue;
+
+            mPiece_.clear();
+            int u = start;
+            int side = s;
+
+            do
+            {
+                if (mWalked_[side] || int(mPiece_.size()) >= count)
+                    return false;
+
+                mWalked_[side] = 1;
+                mPiece_.push_back(u);
+
+                const int v = mNeighbours_[side];
+                const int back = slot(v, u);
+                const int first = mNeighbourStarts_[v];
+                const int w = mNeighbours_[back == first ? mNeighbourStarts_[v + 1] - 1 : back - 1];
+
+                side = slot(v, w);
+                u = v;
+            } while (side != s);
+
+            if (!triangulate_piece(indices))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+bool MonotoneTriangulator::triangulate_piece(std::vector<int>& indices)
+{
+    const int size = mPiece_.size();
+    if (size < 3)
+        return false;
+
+    if (size == 3)
+    {
+        emit(mPiece_[0], mPiece_[1], mPiece_[2], indices);
+        return true;
+    }
+
+    int top = 0;
+    int bottom = 0;
+    for (int i = 1; i < size; i++)
+    {
+        if (above(mPiece_[i], mPiece_[top]))
+            top = i;
+        if (above(mPiece_[bottom], mPiece_[i]))
+            bottom = i;
+    }
+
+    // - counter clockwise from the top goes down the left chain, clockwise the right one.
+    // Both are merged from top to bottom
+    mSorted_.clear();
+    mLeftChain_.clear();
+    mSorted_.push_back(mPiece_[top]);
+    mLeftChain_.push_back(1);
+
+    int left = (top + 1) % size;
+    int right = (top + size - 1) % size;
+
+    while (int(mSorted_.size()) < size)
+    {
+        // - the bottom closes the left chain, once the right one is done
+        const bool take_left = right == bottom || (left != bottom && above(mPiece_[left], mPiece_[right]));
+
+        if (take_left)
+        {
+            if (!above(mPiece_[(left + size - 1) % size], mPiece_[left]))
+                return false;
+
+            mSorted_.push_back(mPiece_[left]);
+            mLeftChain_.push_back(1);
+            left = (left + 1) % size;
+        }
+        else
+        {
+            if (!above(mPiece_[(right + 1) % size], mPiece_[right]))
+                return false;
+
+            mSorted_.push_back(mPiece_[right]);
+            mLeftChain_.push_back(0);
+            right = (right + size - 1) % size;
+        }
+    }
+
+    mStack_.clear();
+    mStack_.push_back(0);
+    mStack_.push_back(1);
+
+    for (int j = 2; j < size - 1; j++)
+    {
+        if (mLeftChain_[j] != mLeftChain_[mStack_.back()])
+        {
+            // - on the other chain : every point of the stack sees it
+            while (mStack_.size() > 1)
+            {
+                const int v = mStack_.back();
+                mStack_.pop_back();
+                emit(mSorted_[j], mSorted_[v], mSorted_[mStack_.back()], indices);
+            }
+
+            mStack_.clear();
+            mStack_.push_back(j - 1);
+            mStack_.push_back(j);
+        }
+        else
+        {
+            // - on the same chain : cut as long as the diagonal stays inside
+            int last = mStack_.back();
+            mStack_.pop_back();
+
+            while (!mStack_.empty())
+            {
+                const double turn = area(mSorted_[mStack_.back()], mSorted_[last], mSorted_[j]);
+                if (mLeftChain_[j] ? turn <= 0.0 : turn >= 0.0)
+                    break;
+
+                emit(mSorted_[j], mSorted_[last], mSorted_[mStack_.back()], indices);
+                last = mStack_.back();
+                mStack_.pop_back();
+            }
+
+            mStack_.push_back(last);
+            mStack_.push_back(j);
+        }
+    }
+
+    // - the bottom sees what is left on the stack
+    int last = mStack_.back();
+    mStack_.pop_back();
+    while (!mStack_.empty())
+    {
+        emit(mSorted_[size - 1], mSorted_[last], mSorted_[mStack_.back()], indices);
+        last = mStack_.back();
+        mStack_.pop_back();
+    }
+
+    return true;
+}
+
+void MonotoneTriangulator::emit(int a, int b, int c, std::vector<int>& indices)
+{
+    // - counter clockwise here, then in the orientation of the ring
+    if ((area(a, b, c) < 0.0) != mReversed_)
+        std::swap(b, c);
+
+    indices.push_back(mPoints_[a].index);
+    indices.push_back(mPoints_[b].index);
+    indices.push_back(mPoints_[c].index);
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <vector>
+
+// - triangulation in O(n log n) for large rings : a sweep line from the top adds the
+// diagonals cutting the ring into y-monotone pieces (at split and merge vertices,
+// through the helper of the edge on their left), then each piece is triangulated in
+// linear time with a stack walking down both of its chains at once.
+// Only simple rings are handled : if the ring turns out to cross itself, nothing is
+// pushed and the caller falls back on ear clipping
+class MonotoneTriangulator
+{
+public:
+    // - triangulates the ring of points [begin, end) (x, y pairs), pushing the indices
+    // of the 3 points of each triangle in the ring's orientation. Duplicated and flat
+    // vertices are skipped. Returns false, with nothing pushed, if the ring isn't simple
+    bool triangulate(const float* points, int begin, int end, std::vector<int>& indices);
+
+private:
+    struct Point
+    {
+        double x;
+        double y;
+        // - index of the point
+        int index;
+    };
+
+    enum class Type : unsigned char
+    {
+        Start,
+        End,
+        Split,
+        Merge,
+        Regular
+    };
+
+    // - point of the sweep, to look edges up by position in the status
+    struct Probe
+    {
+        int point;
+    };
+
+    // - edges crossing the sweep line from left to right. Edges never cross, so the order
+    // found when one is inserted holds as long as it stays
+    struct StatusOrder
+    {
+        using is_transparent = void;
+        const MonotoneTriangulator* triangulator;
+
+        bool operator()(int a, int b) const { return triangulator->edge_before(a, b); }
+        bool operator()(int edge, Probe probe) const { return triangulator->left_of(edge, probe.point); }
+        bool operator()(Probe probe, int edge) const { return triangulator->right_of(edge, probe.point); }
+    };
+
+    // - keeps the points of the ring without duplicates and flat vertices, counter clockwise
+    void load(const float* points, int begin, int end);
+    int prev(int i) const { return i == 0 ? int(mPoints_.size()) - 1 : i - 1; }
+    int next(int i) const { return i + 1 == int(mPoints_.size()) ? 0 : i + 1; }
+    // - a is met before b by the sweep : higher, or as high and on the left
+    bool above(int a, int b) const;
+    // - twice the signed area of a b c, positive counter clockwise
+    double area(int a, int b, int c) const;
+    void classify();
+    // - edge i goes from point i to the next one
+    int upper(int edge) const;
+    int lower(int edge) const;
+    // - the edge passes left (right) of a point between its ends
+    bool left_of(int edge, int point) const;
+    bool right_of(int edge, int point) const;
+    bool edge_before(int a, int b) const;
+    bool add_diagonals();
+    // - walks the faces left of the edges and diagonals, triangulating each one
+    bool split_pieces(std::vector<int>& indices);
+    bool triangulate_piece(std::vector<int>& indices);
+    void emit(int a, int b, int c, std::vector<int>& indices);
+
+    std::vector<Point> mPoints_;
+    std::vector<Type> mTypes_;
+    std::vector<int> mEvents_;
+    // - per edge in the status, the lowest point seen right of it so far
+    std::vector<int> mHelpers_;
+    std::vector<int> mDiagonals_;
+    // - neighbours of every point (edges and diagonals) counter clockwise around it,
+    // point i's from mNeighbourStarts_[i], and the sides already walked
+    std::vector<int> mNeighbourStarts_;
+    std::vector<int> mNeighbours_;
+    std::vector<char> mWalked_;
+    std::vector<int> mPiece_;
+    std::vector<int> mSorted_;
+    std::vector<char> mLeftChain_;
+    std::vector<int> mStack_;
+    bool mReversed_ = false;
+};
@@ -0,0 +1,185 @@
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+#include "ScanlineFill.h"
+#include "ThreadPool.h"
+
+// - a band is worth a task from this many rows, and a few bands per thread balance
+// the rows with many spans
+static const int MIN_BAND_ROWS = 64;
+static const int BANDS_PER_THREAD = 4;
+
+// - fractional bits of x. Values are clamped to 2^30 pixels, far past any coordinate,
+// so an x plus its steps over the rows of its edge stays in range
+static const int FIXED_BITS = 32;
+static const double FIXED_ONE = 4294967296.0;
+static const double FIXED_LIMIT = 1073741824.0;
+// - the step is rounded, so an x landing on a whole pixel after many rows can be a few
+// units off it. Ends this close to a whole pixel are taken as on it
+static const long long FIXED_SNAP = 1 << 12;
+
+static long long to_fixed(double value)
+{
+    return std::llround(std::min(std::max(value, -FIXED_LIMIT), FIXED_LIMIT) * FIXED_ONE);
+}
+
+void ScanlineFill::fill(const std::vector<std::unique_ptr<Edge>>& edges, std::vector<float>& lines, ThreadPool* pool)
+{
+    build_edge_table(edges);
+
+    if (mEdgeTable_.empty())
+        return;
+
+    // - every edge is gone on the last row, there is nothing to draw on it
+    const int rows = mLastRow_ - mFirstRow_;
+    const int bands = pool == nullptr ? 1 : std::min(rows / MIN_BAND_ROWS, pool->threads() * BANDS_PER_THREAD);
+
+    if (bands < 2)
+    {
+        fill_band(mFirstRow_, mLastRow_, mActive_, lines);
+        return;
+    }
+
+    mBands_.resize(std::max(int(mBands_.size()), bands));
+
+    pool->parallel_for(bands, 1, [&](int begin, int end, int)
+    {
+        for (int b = begin; b < end; b++)
+        {
+            mBands_[b].lines.clear();
+            fill_band(mFirstRow_ + rows * b / bands, mFirstRow_ + rows * (b + 1) / bands, mBands_[b].active, mBands_[b].lines);
+        }
+    });
+
+    // - bands are in row order, appending them gives the rows in order
+    size_t size = lines.size();
+    for (int b = 0; b < bands; b++)
+        size += mBands_[b].lines.size();
+
+    lines.reserve(size);
+    for (int b = 0; b < bands; b++)
+        lines.insert(lines.end(), mBands_[b].lines.begin(), mBands_[b].lines.end());
+}
+
+void ScanlineFill::build_edge_table(const std::vector<std::unique_ptr<Edge>>& edges)
+{
+    mBuckets_.clear();
+    mEdgeTable_.clear();
+    mFirstRow_ = INT_MAX;
+    mLastRow_ = INT_MIN;
+
+    for (auto&& edge : edges)
+    {
+        const int y_min = int(std::ceil(edge->minY()));
+        const int y_max = int(std::ceil(edge->maxY()));
+
+        // - horizontal edges (or shorter than a row) cross no row
+        if (y_min >= y_max)
+            continue;
+
+        // - the step comes from the end points in double, the float inverse slope of the
+        // edge is too coarse once multiplied by many rows. An off grid end point moves x
+        // to the first row crossed
+        const bool up = edge->y1_ < edge->y2_;
+        const double x_low = up ? edge->x1_ : edge->x2_;
+        const double x_high = up ? edge->x2_ : edge->x1_;
+        const double step = (x_high - x_low) / (double(edge->maxY()) - edge->minY());
+
+        Bucket bucket;
+        bucket.y_min = y_min;
+        bucket.y_max = y_max;
+        bucket.x = to_fixed(x_low + (double(y_min) - edge->minY()) * step);
+        bucket.step = to_fixed(step);
+        bucket.current_x = bucket.x;
+
+        mBuckets_.push_back(bucket);
+        mFirstRow_ = std::min(mFirstRow_, y_min);
+        mLastRow_ = std::max(mLastRow_, y_max);
+    }
+
+    if (mBuckets_.empty())
+        return;
+
+    // - counting sort by first row. Counts go 2 slots further, so that once the prefix
+    // sums are done placing the buckets of row r moves slot r + 1 from the start of row r
+    // to the start of row r + 1, and slot r ends up holding the start of row r
+    const int rows = mLastRow_ - mFirstRow_;
+    mRowStarts_.assign(rows + 2, 0);
+
+    for (const auto& bucket : mBuckets_)
+        mRowStarts_[bucket.y_min - mFirstRow_ + 2]++;
+
+    for (int r = 2; r < rows + 2; r++)
+        mRowStarts_[r] += mRowStarts_[r - 1];
+
+    mEdgeTable_.resize(mBuckets_.size());
+    for (const auto& bucket : mBuckets_)
+        mEdgeTable_[mRowStarts_[bucket.y_min - mFirstRow_ + 1]++] = bucket;
+}
+
+void ScanlineFill::fill_band(const int begin, const int end, std::vector<Bucket>& active, std::vector<float>& lines) const
+{
+    // - seed the band with the edges started above it and still crossing its first row,
+    // in edge table order like the rows before would have left them
+    active.clear();
+    for (int i = 0; i < mRowStarts_[begin - mFirstRow_]; i++)
+        if (mEdgeTable_[i].y_max > begin)
+            active.push_back(mEdgeTable_[i]);
+
+    for (int y = begin; y < end; y++)
+    {
+        update_active_edges(active, y);
+
+        for (auto& bucket : active)
+            bucket.current_x = bucket.x + (y - bucket.y_min) * bucket.step;
+
+        sort_active_edges(active);
+        compute_line_coordinates(active, lines, y);
+    }
+}
+
+void ScanlineFill::update_active_edges(std::vector<Bucket>& active, const int row) const
+{
+    // - drop the edges ending on this row, then add the ones starting on it
+    active.erase(std::remove_if(active.begin(), active.end(), [row](const Bucket& bucket)
+    {
+        return bucket.y_max == row;
+    }), active.end());
+
+    const int r = row - mFirstRow_;
+    active.insert(active.end(), mEdgeTable_.begin() + mRowStarts_[r], mEdgeTable_.begin() + mRowStarts_[r + 1]);
+}
+
+void ScanlineFill::sort_active_edges(std::vector<Bucket>& active) const
+{
+    // - insertion sort : the list is still sorted from the previous row except where
+    // edges were added or crossed each other, so this is linear most of the time
+    for (size_t i = 1; i < active.size(); i++)
+    {
+        const Bucket bucket = active[i];
+        size_t j = i;
+
+        while (j > 0 && bucket.current_x < active[j - 1].current_x)
+        {
+            active[j] = active[j - 1];
+            j--;
+        }
+
+        active[j] = bucket;
+    }
+}
+
+void ScanlineFill::compute_line_coordinates(const std::vector<Bucket>& active, std::vector<float>& lines, const int y) const
+{
+    // - spans between the edges of even and odd index, an odd edge left over is ignored.
+    // Shifting right rounds toward minus infinity, which is the floor, and the ceiling
+    // is the floor of the opposite
+    for (size_t i = 0; i + 1 < active.size(); i += 2)
+    {
+        lines.push_back(float(-((FIXED_SNAP - active[i].current_x) >> FIXED_BITS)));
+        lines.push_back(float(y));
+        lines.push_back(float((active[i + 1].current_x + FIXED_SNAP) >> FIXED_BITS));
+        lines.push_back(float(y));
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Edge.h"
+
+class ThreadPool;
+
+// - scanline fill with an edge table bucketed by row. Edges are sorted into their
+// first row with a counting sort, the active edges are kept ordered by x with an
+// insertion sort (they barely move from one row to the next), and every buffer is
+// reused between calls. O(edges + rows + spans), no allocation once warmed up.
+// x is kept in fixed point : its value on the first row of an edge and its change per
+// row are rounded once, then x on any row is that value plus a whole number of steps,
+// computed exactly in integers. Rows don't accumulate rounding like a float step did,
+// the span ends are a shift instead of ceil / floor (ends within a few units of a whole
+// pixel count as on it, the step being rounded), and since x is evaluated from the
+// first row instead of being stepped, tall shapes can be split in bands of rows filled
+// on a pool with the same spans whatever the split
+class ScanlineFill
+{
+public:
+    // - each span is pushed as 2 points (4 floats). An edge covers the rows y with
+    // y_min <= y < y_max, spans go from the ceiling of the left x to the floor of the
+    // right one (even-odd rule). With a pool, shapes taller than a few bands are
+    // filled band by band on it. Must not be called from a task of that pool
+    void fill(const std::vector<std::unique_ptr<Edge>>& edges, std::vector<float>& lines, ThreadPool* pool = nullptr);
+
+private:
+    struct Bucket
+    {
+        int y_min;
+        int y_max;
+        // - x on row y_min, on the current row, and its change from one row to the
+        // next, with FIXED_BITS fractional bits
+        long long x;
+        long long current_x;
+        long long step;
+    };
+
+    // - rows and spans of one band
+    struct Band
+    {
+        std::vector<Bucket> active;
+        std::vector<float> lines;
+    };
+
+    void build_edge_table(const std::vector<std::unique_ptr<Edge>>& edges);
+    void fill_band(int begin, int end, std::vector<Bucket>& active, std::vector<float>& lines) const;
+    void update_active_edges(std::vector<Bucket>& active, int row) const;
+    void sort_active_edges(std::vector<Bucket>& active) const;
+    void compute_line_coordinates(const std::vector<Bucket>& active, std::vector<float>& lines, int y) const;
+
+    int mFirstRow_ = 0;
+    int mLastRow_ = 0;
+    // - arena of the buckets in edge order, then the same buckets grouped by first row :
+    // row r starts at mRowStarts_[r - mFirstRow_] and ends where row r + 1 starts
+    std::vector<Bucket> mBuckets_;
+    std::vector<Bucket> mEdgeTable_;
+    std::vector<int> mRowStarts_;
+    // - edges crossing the current row, ordered by x
+    std::vector<Bucket> mActive_;
+    std::vector<Band> mBands_;
+};
@@ -0,0 +1,537 @@
+#include <atomic>
+#include <cmath>
+#include <algorithm>
+
+#include "Shape.h"
+#include "BooleanSweep.h"
+#include "ClipKernel.h"
+#include "EarClipper.h"
+#include "GreinerHormann.h"
+#include "IntegerClipKernel.h"
+#include "MonotoneTriangulator.h"
+#include "ScanlineFill.h"
+#include "SubdivisionKernel.h"
+#include "TrapezoidFill.h"
+
+// - ear clipping is quadratic at worst, past this many points the monotone sweep wins
+static const int MONOTONE_MIN_POINTS = 2000;
+
+Shape::Shape()
+    :mVertexSize_(0), mTranslation_{ 0.0f, 0.0f }
+{
+    touch();
+}
+
+void Shape::addPoint(float x, float y)
+{
+    mMousePoints_.push_back(x);
+    mMousePoints_.push_back(y);
+    mContourEnds_.clear();
+
+    mVertexSize_ = mMousePoints_.size() / 2;
+
+    update_edges();
+}
+
+void Shape::addPoints(const float* points, int count)
+{
+    mMousePoints_.insert(mMousePoints_.end(), points, points + count * 2);
+    mContourEnds_.clear();
+
+    mVertexSize_ = mMousePoints_.size() / 2;
+
+    update_edges();
+}
+
+void Shape::setPoints(std::vector<float> points)
+{
+    mMousePoints_ = std::move(points);
+    mContourEnds_.clear();
+
+    mVertexSize_ = mMousePoints_.size() / 2;
+
+    update_edges();
+}
+
+void Shape::setContours(std::vector<float> points, std::vector<int> contour_ends)
+{
+    mMousePoints_ = std::move(points);
+    mContourEnds_ = std::move(contour_ends);
+
+    // - keep the single contour case as the default representation
+    if (mContourEnds_.size() < 2)
+        mContourEnds_.clear();
+
+    mVertexSize_ = mMousePoints_.size() / 2;
+
+    update_edges();
+}
+
+void Shape::clear()
+{
+    mMousePoints_.clear();
+    mContourEnds_.clear();
+    mEdges_.clear();
+    mVertexSize_ = 0;
+    update_bounds();
+    update_convexity();
+    touch();
+    onUpdate();
+}
+
+BoundingBox Shape::bounds() const
+{
+    if (mBounds_.empty())
+        return mBounds_;
+
+    return { mBounds_.x_min + mTranslation_[0], mBounds_.y_min + mTranslation_[1], mBounds_.x_max + mTranslation_[0], mBounds_.y_max + mTranslation_[1] };
+}
+
+void Shape::setTranslation(float x, float y)
+{
+    if (x == mTranslation_[0] && y == mTranslation_[1])
+        return;
+
+    mTranslation_[0] = x;
+    mTranslation_[1] = y;
+    touch(false);
+}
+
+void Shape::sutherlandOgdmann(const Shape& polygon, const Shape& window, bool exact, bool snap)
+{
+    if (exact && snap && clip_exact(polygon, window))
+        return;
+
+    // - clone translated polygon points, edges are only rebuilt once the clipping is over
+    mContourEnds_.clear();
+    mMousePoints_.resize(polygon.mMousePoints_.size());
+    mVertexSize_ = polygon.mVertexSize_;
+
+    for (auto i = 0; i < polygon.mVertexSize_; ++i)
+    {
+        mMousePoints_[i * 2] = polygon.mMousePoints_[i * 2] + polygon.mTranslation_[0];
+        mMousePoints_[i * 2 + 1] = polygon.mMousePoints_[i * 2 + 1] + polygon.mTranslation_[1];
+    }
+
+    // - don't try to clip if the window is a line
+    if (window.mVertexSize_ < 3)
+    {
+        update_edges();
+        return;
+    }
+
+    // - sutherland-hodgman algorithm, the kernel keeps its buffers between calls
+    static thread_local ClipKernel kernel;
+    kernel.load(mMousePoints_.data(), mVertexSize_);
+
+    // - the inside is on the right of each clip line, so counter clockwise windows are
+    // walked backward
+    const int n = window.mVertexSize_;
+    const bool backward = window.mCounterClockwise_;
+
+    for (auto k = 0; k < n && kernel.size() > 0; ++k)
+    {
+        int i = backward ? n - 1 - k : k;
+        int j = backward ? (i + n - 1) % n : (i + 1) % n;
+
+        const float* tr = window.mTranslation_;
+
+        float x1 = window.mMousePoints_[i * 2] + tr[0];
+        float y1 = window.mMousePoints_[i * 2 + 1] + tr[1];
+        float x2 = window.mMousePoints_[j * 2] + tr[0];
+        float y2 = window.mMousePoints_[j * 2 + 1] + tr[1];
+
+        kernel.clip(x1, y1, x2, y2, snap);
+    }
+
+    kernel.store(mMousePoints_);
+    mVertexSize_ = kernel.size();
+
+    update_edges();
+}
+
+bool Shape::clip_exact(const Shape& polygon, const Shape& window)
+{
+    if (window.mVertexSize_ < 3)
+        return false;
+
+    // - translated and snapped window, the kernel keeps its buffers between calls
+    static thread_local IntegerClipKernel kernel;
+    static thread_local std::vector<int> clip_points;
+
+    clip_points.resize(window.mVertexSize_ * 2);
+    for (int i = 0; i < window.mVertexSize_ * 2; i++)
+        if (!IntegerClipKernel::snap(window.mMousePoints_[i] + window.mTranslation_[i % 2], clip_points[i]))
+            return false;
+
+    if (!kernel.load(polygon.mMousePoints_.data(), polygon.mVertexSize_, polygon.mTranslation_[0], polygon.mTranslation_[1]))
+        return false;
+
+    const int n = window.mVertexSize_;
+    const bool backward = window.mCounterClockwise_;
+
+    for (int k = 0; k < n && kernel.size() > 0; ++k)
+    {
+        const int i = backward ? n - 1 - k : k;
+        const int j = backward ? (i + n - 1) % n : (i + 1) % n;
+        kernel.clip(clip_points[i * 2], clip_points[i * 2 + 1], clip_points[j * 2], clip_points[j * 2 + 1]);
+    }
+
+    mContourEnds_.clear();
+    kernel.store(mMousePoints_);
+    mVertexSize_ = kernel.size();
+
+    update_edges();
+    return true;
+}
+
+void Shape::greinerHormann(const Shape& polygon, const Shape& window)
+{
+    // - translated coordinates, in double so crossings are computed precisely
+    std::vector<double> subject(polygon.mMousePoints_.size());
+    std::vector<double> clipper(window.mMousePoints_.size());
+
+    for (size_t i = 0; i < subject.size(); i++)
+        subject[i] = double(polygon.mMousePoints_[i]) + polygon.mTranslation_[i % 2];
+
+    for (size_t i = 0; i < clipper.size(); i++)
+        clipper[i] = double(window.mMousePoints_[i]) + window.mTranslation_[i % 2];
+
+    std::vector<float> points;
+    std::vector<int> contour_ends;
+    GreinerHormann greiner_hormann;
+    greiner_hormann.clip(subject, clipper, points, contour_ends);
+
+    // - snap to the pixel grid like sutherland-hodgman does
+    for (auto& coordinate : points)
+        coordinate = floor(coordinate);
+
+    setContours(std::move(points), std::move(contour_ends));
+}
+
+void Shape::booleanOperation(const std::vector<const Shape*>& subject, const std::vector<const Shape*>& clipping, BooleanOperation operation)
+{
+    BooleanSweep sweep;
+    std::vector<double> translated;
+
+    for (int operand = 0; operand < 2; operand++)
+    {
+        for (const Shape* shape : operand == 0 ? subject : clipping)
+        {
+            translated.resize(shape->mMousePoints_.size());
+            for (size_t i = 0; i < translated.size(); i++)
+                translated[i] = double(shape->mMousePoints_[i]) + shape->mTranslation_[i % 2];
+
+            sweep.addShape(operand, translated, shape->mContourEnds_);
+        }
+    }
+
+    std::vector<float> points;
+    std::vector<int> contour_ends;
+    sweep.compute(operation, points, contour_ends);
+
+    // - snap to the pixel grid like the clipping algorithms do
+    for (auto& coordinate : points)
+        coordinate = floor(coordinate);
+
+    setContours(std::move(points), std::move(contour_ends));
+}
+
+void Shape::computeBoundingBox(Shape& box)
+{
+    // - clear previous vertices
+    box.mVertexSize_ = 0;
+    box.mMousePoints_.clear();
+
+    // - return if the polygon is not created yet
+    if (mVertexSize_ < 3)
+        return;
+
+    const BoundingBox& b = mBounds_;
+
+    // - fill the bounding box anti clockwise
+    box.setPoints({ b.x_min, b.y_min, b.x_min, b.y_max, b.x_max, b.y_max, b.x_max, b.y_min });
+}
+
+void Shape::fill_LCA(std::vector<float>& lines, ThreadPool* pool) const
+{
+    // - on ne peut pas remplir un point ou une ligne
+    if (mEdges_.size() < 3)
+        return;
+
+    // - the fill keeps its buckets between calls
+    static thread_local ScanlineFill fill;
+    fill.fill(mEdges_, lines, pool);
+}
+
+void Shape::fillTrapezoids(std::vector<float>& triangles) const
+{
+    if (mEdges_.size() < 3)
+        return;
+
+    static thread_local TrapezoidFill fill;
+    fill.fill(mEdges_, triangles);
+}
+
+void Shape::fillCoverage(CoverageMask& mask) const
+{
+    mask.x = mask.y = mask.width = mask.height = 0;
+    mask.coverage.clear();
+
+    if (mVertexSize_ < 3)
+        return;
+
+    // - whole pixels around the bounds
+    const BoundingBox& b = mBounds_;
+    mask.x = int(floor(b.x_min));
+    mask.y = int(floor(b.y_min));
+    mask.width = int(ceil(b.x_max)) - mask.x;
+    mask.height = int(ceil(b.y_max)) - mask.y;
+
+    static thread_local CoverageFill fill;
+    fill.fill(*this, mask);
+}
+
+void Shape::fillSpans(SpanFill& spans, ThreadPool* pool) const
+{
+    static thread_local std::vector<float> lines;
+    lines.clear();
+    fill_LCA(lines, pool);
+    spans.assign(lines);
+}
+
+void Shape::triangulate(std::vector<int>& indices) const
+{
+    static thread_local EarClipper clipper;
+    static thread_local MonotoneTriangulator monotone;
+
+    for (int contour = 0; contour < contours(); contour++)
+    {
+        const int begin = contourBegin(contour);
+        const int end = contourEnd(contour);
+
+        // - large rings through the sweep, unless they cross themselves
+        if (end - begin >= MONOTONE_MIN_POINTS && monotone.triangulate(mMousePoints_.data(), begin, end, indices))
+            continue;
+
+        clipper.triangulate(mMousePoints_.data(), begin, end, indices);
+    }
+}
+
+void Shape::ear_clipping(std::vector<float>& triangles) const
+{
+    static thread_local std::vector<int> indices;
+    indices.clear();
+    triangulate(indices);
+
+    triangles.reserve(triangles.size() + indices.size() * 2);
+    for (int index : indices)
+    {
+        triangles.push_back(mMousePoints_[index * 2] + mTranslation_[0]);
+        triangles.push_back(mMousePoints_[index * 2 + 1] + mTranslation_[1]);
+    }
+}
+
+void Shape::fractalise(int levels)
+{
+    refine(levels, true);
+}
+
+void Shape::subdivise(int levels)
+{
+    refine(levels, false);
+}
+
+void Shape::refine(int levels, bool fractal)
+{
+    if (levels <= 0 || mVertexSize_ == 0)
+        return;
+
+    // - only used by the calling thread. The new points are written in place of the
+    // buffer the previous call swapped out, so repeated calls stop allocating
+    static thread_local SubdivisionKernel kernel;
+    static thread_local std::vector<float> points;
+    points.resize(mMousePoints_.size() << levels);
+
+    // - every contour keeps its place, each of its points becomes 2^levels of them
+    for (int contour = 0; contour < contours(); contour++)
+    {
+        const int begin = contourBegin(contour);
+        kernel.load(mMousePoints_.data() + begin * 2, contourEnd(contour) - begin);
+
+        if (fractal)
+            kernel.fractalise(levels);
+        else
+            kernel.subdivide(levels);
+
+        kernel.store(points.data() + ((size_t)begin << levels) * 2);
+    }
+
+    for (int& end : mContourEnds_)
+        end <<= levels;
+
+    mMousePoints_.swap(points);
+    mVertexSize_ = mMousePoints_.size() / 2;
+
+    update_edges();
+}
+
+void Shape::subdiviseAdaptive(float tolerance, float max_turn, int max_levels)
+{
+    if (max_levels <= 0 || mVertexSize_ == 0)
+        return;
+
+    // - only used by the calling thread and kept from one call to the next. The size
+    // of each contour is only known once it's refined
+    static thread_local SubdivisionKernel kernel;
+    static thread_local std::vector<float> points;
+    points.clear();
+
+    // - the ends are replaced as the contours are done
+    int begin = 0;
+    for (int contour = 0; contour < contours(); contour++)
+    {
+        const int end = contourEnd(contour);
+        kernel.load(mMousePoints_.data() + begin * 2, end - begin);
+        kernel.subdivideAdaptive(tolerance, max_turn, max_levels);
+        begin = end;
+
+        const size_t offset = points.size();
+        points.resize(offset + kernel.size() * 2);
+        kernel.store(points.data() + offset);
+
+        if (!mContourEnds_.empty())
+            mContourEnds_[contour] = points.size() / 2;
+    }
+
+    mMousePoints_.swap(points);
+    mVertexSize_ = mMousePoints_.size() / 2;
+
+    update_edges();
+}
+
+void Shape::update_bounds()
+{
+    mBounds_ = BoundingBox();
+
+    if (mVertexSize_ == 0)
+        return;
+
+    float x_min = mMousePoints_[0];
+    float y_min = mMousePoints_[1];
+    float x_max = x_min;
+    float y_max = y_min;
+
+    for (int i = 1; i < mVertexSize_; i++)
+    {
+        x_min = std::min(x_min, mMousePoints_[i * 2]);
+        x_max = std::max(x_max, mMousePoints_[i * 2]);
+        y_min = std::min(y_min, mMousePoints_[i * 2 + 1]);
+        y_max = std::max(y_max, mMousePoints_[i * 2 + 1]);
+    }
+
+    mBounds_ = { x_min, y_min, x_max, y_max };
+}
+
+void Shape::update_edges()
+{
+    // - clear and recreate edges (can be optimized : remove last entry and create 2 
+    // new edge : [last, current], [current, first]
+    mEdges_.clear();
+    for (int contour = 0; contour < contours(); contour++)
+    {
+        const int begin = contourBegin(contour);
+        const int end = contourEnd(contour);
+
+        for (int i = begin; i < end; i++)
+        {
+            int next = i + 1 == end ? begin : i + 1;
+
+            mEdges_.push_back(std::make_unique<Edge>(mMousePoints_[i * 2], mMousePoints_[i * 2 + 1], mMousePoints_[next * 2], mMousePoints_[next * 2 + 1]));
+        }
+    }
+
+    // - sort edges by y_min
+
+    std::sort(mEdges_.begin(), mEdges_.end(), [](const std::unique_ptr<Edge>& lhs, const std::unique_ptr<Edge>& rhs)
+    {
+        if (lhs->minY() == rhs->minY())
+            return lhs->getInvDir() < rhs->getInvDir();
+
+        return lhs->minY() < rhs->minY();
+    });
+
+    update_bounds();
+    update_convexity();
+    touch();
+    onUpdate();
+}
+
+void Shape::update_convexity()
+{
+    mConvex_ = false;
+    mCounterClockwise_ = false;
+
+    if (!mContourEnds_.empty() || mVertexSize_ < 3)
+        return;
+
+    const float* p = mMousePoints_.data();
+    const int n = mVertexSize_;
+    float area = 0.0f;
+    int turn = 0;
+    int x_flips = 0;
+    int y_flips = 0;
+    float last_dx = 0.0f;
+    float last_dy = 0.0f;
+
+    // - every turn goes the same way and the edges only go back and forth twice on
+    // each axis, which rules out contours winding more than once
+    for (int i = 0; i <= n; i++)
+    {
+        const int a = i % n;
+        const int b = (i + 1) % n;
+        const int c = (i + 2) % n;
+        const float dx = p[b * 2] - p[a * 2];
+        const float dy = p[b * 2 + 1] - p[a * 2 + 1];
+
+        if (i < n)
+        {
+            area += p[a * 2] * p[b * 2 + 1] - p[b * 2] * p[a * 2 + 1];
+
+            const float cross = dx * (p[c * 2 + 1] - p[b * 2 + 1]) - dy * (p[c * 2] - p[b * 2]);
+            const int sign = (cross > 0.0f) - (cross < 0.0f);
+            if (sign != 0 && turn != 0 && sign != turn)
+                return;
+            if (sign != 0)
+                turn = sign;
+        }
+
+        if (dx != 0.0f)
+        {
+            x_flips += last_dx != 0.0f && (dx > 0.0f) != (last_dx > 0.0f);
+            last_dx = dx;
+        }
+
+        if (dy != 0.0f)
+        {
+            y_flips += last_dy != 0.0f && (dy > 0.0f) != (last_dy > 0.0f);
+            last_dy = dy;
+        }
+    }
+
+    if (turn == 0 || x_flips > 2 || y_flips > 2)
+        return;
+
+    mConvex_ = true;
+    mCounterClockwise_ = area > 0.0f;
+}
+
+void Shape::touch(bool points)
+{
+    // - shared by every shape (and thread), so a revision identifies one state of one shape
+    static std::atomic<unsigned long long> next_revision(1);
+    mRevision_ = next_revision++;
+
+    if (points)
+        mPointsRevision_ = mRevision_;
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "BooleanSweep.h"
+#include "CoverageFill.h"
+#include "Edge.h"
+#include "SpanFill.h"
+
+class ThreadPool;
+
+struct Vertex
+{
+    Vertex(const float x_, const float y_) { x = x_;  y = y_;  }
+    float x;
+    float y;
+};
+
+struct BoundingBox
+{
+    float x_min = 1.0f;
+    float y_min = 1.0f;
+    float x_max = -1.0f;
+    float y_max = -1.0f;
+
+    bool empty() const { return x_min > x_max; }
+    // - touching boxes overlap, an empty box overlaps nothing
+    bool overlaps(const BoundingBox& b) const
+    {
+        return !empty() && !b.empty() && x_min <= b.x_max && b.x_min <= x_max && y_min <= b.y_max && b.y_min <= y_max;
+    }
+};
+
+// - cpu side of a polygon : points, edges and every algorithm working on them.
+// No OpenGL here so it can run on a headless machine (see ClipBatch)
+class Shape
+{
+public:
+    Shape();
+    Shape(Shape&& s) = default;
+    Shape& operator=(Shape&& s) = default;
+    virtual ~Shape() = default;
+
+    void addPoint(float x, float y);
+    // - bulk versions of addPoint : edges are rebuilt and uploaded once for the whole set
+    void addPoints(const float* points, int count);
+    void setPoints(std::vector<float> points);
+    // - several closed contours, contour_ends holds the end index (in points) of each one
+    void setContours(std::vector<float> points, std::vector<int> contour_ends);
+    void clear();
+    void setTranslation(float x, float y);
+    // - clip against a convex window, in either orientation. exact clips on the integer grid instead (see
+    // IntegerClipKernel), it falls back to floats if a coordinate is out of its range.
+    // Without snap the points stay off the pixel grid, and exact is ignored
+    void sutherlandOgdmann(const Shape& polygon, const Shape& window, bool exact = false, bool snap = true);
+    // - clip against any window, the result may have several contours
+    void greinerHormann(const Shape& polygon, const Shape& window);
+    // - subject <operation> clipping, each side being the union of its shapes (see
+    // BooleanSweep). Holes are contours turning the other way than the outer ones
+    void booleanOperation(const std::vector<const Shape*>& subject, const std::vector<const Shape*>& clipping, BooleanOperation operation);
+    // - each contour triangulated on its own (holes aren't bridged), pushing the indices
+    // of the 3 points of each triangle. Ear clipping (see EarClipper), or a monotone
+    // partition for large contours (see MonotoneTriangulator)
+    void triangulate(std::vector<int>& indices) const;
+    // - each triangle is pushed as 3 translated points (6 floats)
+    void ear_clipping(std::vector<float>& triangles) const;
+    void computeBoundingBox(Shape& box);
+    // - cached box, refreshed with the edges and moved with the translation
+    BoundingBox bounds() const;
+    // - each span is pushed as 2 points (4 floats), ready to be drawn as lines (see ScanlineFill).
+    // With a pool, tall shapes are filled in bands of rows on it
+    void fill_LCA(std::vector<float>& lines, ThreadPool* pool = nullptr) const;
+    // - same fill as trapezoids between edge events, each pushed as 2 triangles of 3
+    // points (see TrapezoidFill). Independent of the pixel grid
+    void fillTrapezoids(std::vector<float>& triangles) const;
+    // - anti-aliased fill : coverage of every pixel of the shape's bounds (see CoverageFill)
+    void fillCoverage(CoverageMask& mask) const;
+    // - the spans of fill_LCA kept as runs of pixels per row, for queries (see SpanFill)
+    void fillSpans(SpanFill& spans, ThreadPool* pool = nullptr) const;
+    // - levels rounds of chaikin corner cutting (or of fractal bumps) on every contour,
+    // computed in one go (see SubdivisionKernel). Edges are rebuilt and uploaded once
+    void subdivise(int levels = 1);
+    void fractalise(int levels = 1);
+    // - corner cutting only where it changes the shape by more than tolerance pixels,
+    // or where it turns by more than max_turn radians, up to max_levels levels
+    // (see SubdivisionKernel::subdivideAdaptive)
+    void subdiviseAdaptive(float tolerance, float max_turn, int max_levels);
+    int size() const { return mVertexSize_; }
+    int contours() const { return mContourEnds_.empty() ? 1 : mContourEnds_.size(); }
+    int contourBegin(int contour) const { return contour == 0 ? 0 : mContourEnds_[contour - 1]; }
+    int contourEnd(int contour) const { return mContourEnds_.empty() ? mVertexSize_ : mContourEnds_[contour]; }
+    const std::vector<float>& points() const { return mMousePoints_; }
+    // - empty when the shape is a single contour
+    const std::vector<int>& contourEnds() const { return mContourEnds_; }
+    // - changes each time the points or the translation change and is never reused,
+    // even by another shape. Anything computed from the shape is stale once it differs
+    unsigned long long revision() const { return mRevision_; }
+    // - same, but only changes with the points. For what is computed without the
+    // translation, like the fill
+    unsigned long long pointsRevision() const { return mPointsRevision_; }
+    // - single contour, at least a triangle, never turning back. Such a shape can be
+    // used as a sutherland-hodgman window without being triangulated
+    bool convex() const { return mConvex_; }
+    const float* translation() const { return mTranslation_; }
+
+    // - called each time the points change, override it to upload them somewhere
+    virtual void onUpdate() {}
+
+protected:
+    void update_edges();
+    void update_bounds();
+    void touch(bool points = true);
+    void update_convexity();
+    void refine(int levels, bool fractal);
+    bool clip_exact(const Shape& polygon, const Shape& window);
+
+    std::vector<std::unique_ptr<Edge>> mEdges_;
+
+    std::vector<float> mMousePoints_;
+    int mVertexSize_;
+    // - empty when the shape is a single contour
+    std::vector<int> mContourEnds_;
+    // - without translation
+    BoundingBox mBounds_;
+
+    float mTranslation_[2];
+    unsigned long long mRevision_;
+    unsigned long long mPointsRevision_;
+    bool mConvex_ = false;
+    // - positive area : sutherland-hodgman walks the edges backward
+    bool mCounterClockwise_ = false;
+};
@@ -0,0 +1,382 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+#include "SoftwareRenderer.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SOFTWARE_RENDERER_SSE2
+#endif
+
+// - pixels on a side of a tile
+static const int TILE_SIZE = 64;
+
+static unsigned char to_byte(float component)
+{
+    return (unsigned char)(std::min(std::max(component, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+// - x / 255 rounded, exact for x <= 255 * 255
+static int divide_255(int x)
+{
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+SoftwareRenderer::SoftwareRenderer(int width, int height)
+    :mWidth_(std::max(width, 0)), mHeight_(std::max(height, 0))
+{
+    mTilesX_ = (mWidth_ + TILE_SIZE - 1) / TILE_SIZE;
+    mTilesY_ = (mHeight_ + TILE_SIZE - 1) / TILE_SIZE;
+    mPixels_.assign(size_t(mWidth_) * mHeight_ * 4, 0);
+    mBins_.resize(mTilesX_ * mTilesY_);
+}
+
+void SoftwareRenderer::clear(float r, float g, float b, float a)
+{
+    const unsigned char color[4] = { to_byte(r), to_byte(g), to_byte(b), to_byte(a) };
+    for (size_t i = 0; i < mPixels_.size(); i += 4)
+        std::copy(color, color + 4, &mPixels_[i]);
+
+    mPrimitives_.clear();
+    mMasks_.clear();
+    for (auto& bin : mBins_)
+        bin.clear();
+}
+
+void SoftwareRenderer::drawOutline(const Shape& shape, const float color[4])
+{
+    const auto& points = shape.points();
+    const float* tr = shape.translation();
+
+    Primitive line;
+    line.kind = Kind::Line;
+    for (int i = 0; i < 4; i++)
+        line.color[i] = to_byte(color[i]);
+
+    for (int contour = 0; contour < shape.contours(); contour++)
+    {
+        const int begin = shape.contourBegin(contour);
+        const int end = shape.contourEnd(contour);
+
+        for (int i = begin; i < end; i++)
+        {
+            const int j = i + 1 == end ? begin : i + 1;
+            line.x[0] = points[i * 2] + tr[0];
+            line.y[0] = points[i * 2 + 1] + tr[1];
+            line.x[1] = points[j * 2] + tr[0];
+            line.y[1] = points[j * 2 + 1] + tr[1];
+            queue(line);
+        }
+    }
+}
+
+void SoftwareRenderer::drawLines(const std::vector<float>& lines, const float translation[2], const float color[4])
+{
+    Primitive line;
+    line.kind = Kind::Line;
+    for (int i = 0; i < 4; i++)
+        line.color[i] = to_byte(color[i]);
+
+    for (size_t i = 0; i + 3 < lines.size(); i += 4)
+    {
+        line.x[0] = lines[i] + translation[0];
+        line.y[0] = lines[i + 1] + translation[1];
+        line.x[1] = lines[i + 2] + translation[0];
+        line.y[1] = lines[i + 3] + translation[1];
+        queue(line);
+    }
+}
+
+void SoftwareRenderer::drawTriangles(const std::vector<float>& triangles, const float translation[2], const float color[4])
+{
+    Primitive triangle;
+    triangle.kind = Kind::Triangle;
+    for (int i = 0; i < 4; i++)
+        triangle.color[i] = to_byte(color[i]);
+
+    for (size_t i = 0; i + 5 < triangles.size(); i += 6)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            triangle.x[k] = triangles[i + k * 2] + translation[0];
+            triangle.y[k] = triangles[i + k * 2 + 1] + translation[1];
+        }
+
+        queue(triangle);
+    }
+}
+
+void SoftwareRenderer::drawCoverage(const CoverageMask& mask, const float translation[2], const float color[4])
+{
+    if (mask.width <= 0 || mask.height <= 0)
+        return;
+
+    Primitive coverage;
+    coverage.kind = Kind::Coverage;
+    coverage.mask = mMasks_.size();
+    for (int i = 0; i < 4; i++)
+        coverage.color[i] = to_byte(color[i]);
+
+    coverage.x[0] = float(mask.x + int(std::lround(translation[0])));
+    coverage.y[0] = float(mask.y + int(std::lround(translation[1])));
+    coverage.x[1] = coverage.x[0] + mask.width;
+    coverage.y[1] = coverage.y[0] + mask.height;
+
+    mMasks_.push_back(mask);
+    queue(coverage);
+}
+
+void SoftwareRenderer::queue(const Primitive& primitive)
+{
+    const int corners = primitive.kind == Kind::Triangle ? 3 : 2;
+    float x_min = primitive.x[0];
+    float x_max = primitive.x[0];
+    float y_min = primitive.y[0];
+    float y_max = primitive.y[0];
+
+    for (int k = 1; k < corners; k++)
+    {
+        x_min = std::min(x_min, primitive.x[k]);
+        x_max = std::max(x_max, primitive.x[k]);
+        y_min = std::min(y_min, primitive.y[k]);
+        y_max = std::max(y_max, primitive.y[k]);
+    }
+
+    if (x_max < 0.0f || y_max < 0.0f || x_min >= mWidth_ || y_min >= mHeight_)
+        return;
+
+    // - a line can light the pixel past its box on the minor axis
+    const int tx0 = std::max(int(std::floor(x_min)) - 1, 0) / TILE_SIZE;
+    const int ty0 = std::max(int(std::floor(y_min)) - 1, 0) / TILE_SIZE;
+    const int tx1 = std::min(int(std::floor(x_max)) + 1, mWidth_ - 1) / TILE_SIZE;
+    const int ty1 = std::min(int(std::floor(y_max)) + 1, mHeight_ - 1) / TILE_SIZE;
+
+    const int index = mPrimitives_.size();
+    mPrimitives_.push_back(primitive);
+
+    for (int ty = ty0; ty <= ty1; ty++)
+        for (int tx = tx0; tx <= tx1; tx++)
+            mBins_[ty * mTilesX_ + tx].push_back(index);
+}
+
+void SoftwareRenderer::flush(ThreadPool* pool)
+{
+    const int tiles = mBins_.size();
+    auto task = [&](int begin, int end, int)
+    {
+        for (int tile = begin; tile < end; tile++)
+            rasterize_tile(tile);
+    };
+
+    if (pool == nullptr)
+        task(0, tiles, 0);
+    else
+        pool->parallel_for(tiles, 1, task);
+
+    mPrimitives_.clear();
+    mMasks_.clear();
+    for (auto& bin : mBins_)
+        bin.clear();
+}
+
+void SoftwareRenderer::rasterize_tile(int tile)
+{
+    // - pixels [x_min, x_max) x [y_min, y_max) belong to this tile only
+    const int x_min = (tile % mTilesX_) * TILE_SIZE;
+    const int y_min = (tile / mTilesX_) * TILE_SIZE;
+    const int x_max = std::min(x_min + TILE_SIZE, mWidth_);
+    const int y_max = std::min(y_min + TILE_SIZE, mHeight_);
+
+    for (int index : mBins_[tile])
+    {
+        const Primitive& primitive = mPrimitives_[index];
+        if (primitive.kind == Kind::Line)
+            draw_line(primitive, x_min, y_min, x_max, y_max);
+        else if (primitive.kind == Kind::Triangle)
+            draw_triangle(primitive, x_min, y_min, x_max, y_max);
+        else
+            draw_coverage(primitive, x_min, y_min, x_max, y_max);
+    }
+}
+
+void SoftwareRenderer::draw_line(const Primitive& line, int x_min, int y_min, int x_max, int y_max)
+{
+    const float dx = line.x[1] - line.x[0];
+    const float dy = line.y[1] - line.y[0];
+
+    // - one pixel per column (or row) whose center lies in [start, end) on the major axis
+    if (std::abs(dx) >= std::abs(dy))
+    {
+        if (dx == 0.0f)
+            return;
+
+        const float start = std::min(line.x[0], line.x[1]);
+        const float end = std::max(line.x[0], line.x[1]);
+        const int first = std::max(int(std::ceil(start - 0.5f)), x_min);
+        const int last = std::min(int(std::ceil(end - 0.5f)), x_max);
+        const float slope = dy / dx;
+
+        // - horizontal lines, every fill span, are a single blend
+        if (dy == 0.0f)
+        {
+            const int y = int(std::floor(line.y[0]));
+            if (y >= y_min && y < y_max)
+                blend_span(y, first, last, line.color);
+            return;
+        }
+
+        for (int x = first; x < last; x++)
+        {
+            const int y = int(std::floor(line.y[0] + (x + 0.5f - line.x[0]) * slope));
+            if (y >= y_min && y < y_max)
+                blend_span(y, x, x + 1, line.color);
+        }
+    }
+    else
+    {
+        const float start = std::min(line.y[0], line.y[1]);
+        const float end = std::max(line.y[0], line.y[1]);
+        const int first = std::max(int(std::ceil(start - 0.5f)), y_min);
+        const int last = std::min(int(std::ceil(end - 0.5f)), y_max);
+        const float slope = dx / dy;
+
+        for (int y = first; y < last; y++)
+        {
+            const int x = int(std::floor(line.x[0] + (y + 0.5f - line.y[0]) * slope));
+            if (x >= x_min && x < x_max)
+                blend_span(y, x, x + 1, line.color);
+        }
+    }
+}
+
+void SoftwareRenderer::draw_triangle(const Primitive& triangle, int x_min, int y_min, int x_max, int y_max)
+{
+    const float top = std::min({ triangle.y[0], triangle.y[1], triangle.y[2] });
+    const float bottom = std::max({ triangle.y[0], triangle.y[1], triangle.y[2] });
+    const int first = std::max(int(std::ceil(top - 0.5f)), y_min);
+    const int last = std::min(int(std::ceil(bottom - 0.5f)), y_max);
+
+    for (int y = first; y < last; y++)
+    {
+        const float center = y + 0.5f;
+        float left = 0.0f;
+        float right = 0.0f;
+        int crossings = 0;
+
+        // - edges crossing the row center, each taken from its upper end point so the
+        // triangles sharing it find the same x
+        for (int k = 0; k < 3; k++)
+        {
+            int a = k;
+            int b = (k + 1) % 3;
+            if (triangle.y[a] > triangle.y[b])
+                std::swap(a, b);
+
+            if (!(center >= triangle.y[a] && center < triangle.y[b]))
+                continue;
+
+            const float x = triangle.x[a] + (center - triangle.y[a]) * (triangle.x[b] - triangle.x[a]) / (triangle.y[b] - triangle.y[a]);
+            left = crossings == 0 ? x : std::min(left, x);
+            right = crossings == 0 ? x : std::max(right, x);
+            crossings++;
+        }
+
+        if (crossings < 2)
+            continue;
+
+        const int begin = std::max(int(std::ceil(left - 0.5f)), x_min);
+        const int end = std::min(int(std::ceil(right - 0.5f)), x_max);
+        blend_span(y, begin, end, triangle.color);
+    }
+}
+
+void SoftwareRenderer::draw_coverage(const Primitive& coverage, int x_min, int y_min, int x_max, int y_max)
+{
+    const CoverageMask& mask = mMasks_[coverage.mask];
+    const int left = int(coverage.x[0]);
+    const int top = int(coverage.y[0]);
+    const int first_x = std::max(left, x_min);
+    const int last_x = std::min(left + mask.width, x_max);
+    const int first_y = std::max(top, y_min);
+    const int last_y = std::min(top + mask.height, y_max);
+
+    unsigned char color[4] = { coverage.color[0], coverage.color[1], coverage.color[2], 0 };
+
+    for (int y = first_y; y < last_y; y++)
+    {
+        const unsigned char* row = &mask.coverage[size_t(y - top) * mask.width];
+
+        // - runs of the same coverage are blended at once, they are most of the mask
+        int x = first_x;
+        while (x < last_x)
+        {
+            const unsigned char value = row[x - left];
+            int end = x + 1;
+            while (end < last_x && row[end - left] == value)
+                end++;
+
+            if (value != 0)
+            {
+                color[3] = (unsigned char)divide_255(coverage.color[3] * value);
+                blend_span(y, x, end, color);
+            }
+
+            x = end;
+        }
+    }
+}
+
+void SoftwareRenderer::blend_span(int y, int begin, int end, const unsigned char color[4])
+{
+    if (begin >= end)
+        return;
+
+    unsigned char* pixel = &mPixels_[(size_t(y) * mWidth_ + begin) * 4];
+    const int alpha = color[3];
+    const int inverse = 255 - alpha;
+    int count = end - begin;
+
+#if defined(SOFTWARE_RENDERER_SSE2)
+    // - 4 pixels at a time, 16 bits per component : color * alpha + pixel * (255 - alpha)
+    // then divided by 255 with the same rounding as the scalar path
+    const __m128i zero = _mm_setzero_si128();
+    short premultiplied[4];
+    for (int c = 0; c < 4; c++)
+        premultiplied[c] = short(color[c] * alpha + 128);
+
+    const __m128i source = _mm_set_epi16(premultiplied[3], premultiplied[2], premultiplied[1], premultiplied[0],
+                                         premultiplied[3], premultiplied[2], premultiplied[1], premultiplied[0]);
+    const __m128i factor = _mm_set1_epi16(short(inverse));
+
+    for (; count >= 4; count -= 4, pixel += 16)
+    {
+        const __m128i destination = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixel));
+
+        __m128i low = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(destination, zero), factor), source);
+        __m128i high = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(destination, zero), factor), source);
+        low = _mm_srli_epi16(_mm_add_epi16(low, _mm_srli_epi16(low, 8)), 8);
+        high = _mm_srli_epi16(_mm_add_epi16(high, _mm_srli_epi16(high, 8)), 8);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pixel), _mm_packus_epi16(low, high));
+    }
+#endif
+
+    for (; count > 0; count--, pixel += 4)
+        for (int c = 0; c < 4; c++)
+            pixel[c] = (unsigned char)divide_255(color[c] * alpha + pixel[c] * inverse);
+}
+
+bool SoftwareRenderer::writePPM(const std::string& path) const
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    file << "P6\n" << mWidth_ << ' ' << mHeight_ << "\n255\n";
+    for (size_t i = 0; i < mPixels_.size(); i += 4)
+        file.write(reinterpret_cast<const char*>(&mPixels_[i]), 3);
+
+    return bool(file);
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Shape.h"
+#include "ThreadPool.h"
+
+// - draws shapes into an rgba image without any GPU, for headless machines and image
+// comparisons. Same conventions as the application : pixel coordinates with y going
+// down, lines covering the pixels whose center they pass through (the last one
+// excluded), triangles the pixels whose center is inside, and colors blended like
+// glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA).
+// Primitives are queued, then binned into square tiles and the tiles are rasterized
+// in parallel, each one drawing its primitives in the order they were queued, so the
+// image is the same whatever the thread count
+class SoftwareRenderer
+{
+public:
+    SoftwareRenderer(int width, int height);
+
+    int width() const { return mWidth_; }
+    int height() const { return mHeight_; }
+    // - 4 bytes (r, g, b, a) per pixel, row after row from the top
+    const std::vector<unsigned char>& pixels() const { return mPixels_; }
+
+    // - colors are r, g, b, a in [0, 1] like the shader uniforms. Clearing drops what
+    // was queued and not flushed
+    void clear(float r, float g, float b, float a = 1.0f);
+    // - one line loop per contour, moved by the shape's translation
+    void drawOutline(const Shape& shape, const float color[4]);
+    // - lines of 2 points (4 floats) each, like fill_LCA spans
+    void drawLines(const std::vector<float>& lines, const float translation[2], const float color[4]);
+    // - triangles of 3 points (6 floats) each, like fillTrapezoids
+    void drawTriangles(const std::vector<float>& triangles, const float translation[2], const float color[4]);
+    // - anti-aliased fill like fillCoverage, the color's alpha scaled by each pixel's
+    // coverage. The mask is copied and moved by the translation rounded to whole pixels
+    void drawCoverage(const CoverageMask& mask, const float translation[2], const float color[4]);
+    // - rasterizes everything queued since the last flush, on the pool if there is one
+    void flush(ThreadPool* pool = nullptr);
+    // - binary ppm, without alpha
+    bool writePPM(const std::string& path) const;
+
+private:
+    enum class Kind : unsigned char
+    {
+        Line,
+        Triangle,
+        Coverage
+    };
+
+    // - a coverage is drawn in the box from its first to its second point, mask is its
+    // index in mMasks_
+    struct Primitive
+    {
+        float x[3];
+        float y[3];
+        int mask;
+        unsigned char color[4];
+        Kind kind;
+    };
+
+    void queue(const Primitive& primitive);
+    void rasterize_tile(int tile);
+    void draw_line(const Primitive& line, int x_min, int y_min, int x_max, int y_max);
+    void draw_triangle(const Primitive& triangle, int x_min, int y_min, int x_max, int y_max);
+    void draw_coverage(const Primitive& coverage, int x_min, int y_min, int x_max, int y_max);
+    // - blends pixels [begin, end) of a row with a color
+    void blend_span(int y, int begin, int end, const unsigned char color[4]);
+
+    int mWidth_;
+    int mHeight_;
+    int mTilesX_;
+    int mTilesY_;
+    std::vector<unsigned char> mPixels_;
+
+    std::vector<Primitive> mPrimitives_;
+    std::vector<CoverageMask> mMasks_;
+    // - per tile, the primitives touching it in queue order
+    std::vector<std::vector<int>> mBins_;
+};
@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+#include "SpanFill.h"
+
+void SpanFill::clear()
+{
+    mFirstRow_ = 0;
+    mRowStarts_.clear();
+    mSpans_.clear();
+}
+
+void SpanFill::assign(const std::vector<float>& lines)
+{
+    clear();
+
+    // - the pixels the renderers light for a horizontal line, rounded the same way
+    auto span_of = [&lines](size_t i, int& y, Span& span)
+    {
+        y = int(std::floor(lines[i + 1]));
+        span.begin = int(std::ceil(std::min(lines[i], lines[i + 2]) - 0.5f));
+        span.end = int(std::ceil(std::max(lines[i], lines[i + 2]) - 0.5f));
+        return span.begin < span.end;
+    };
+
+    int first = INT_MAX;
+    int last = INT_MIN;
+    int y;
+    Span span;
+
+    for (size_t i = 0; i + 3 < lines.size(); i += 4)
+    {
+        if (!span_of(i, y, span))
+            continue;
+
+        first = std::min(first, y);
+        last = std::max(last, y);
+    }
+
+    if (first > last)
+        return;
+
+    // - counting sort of the spans into their row, like the edge table of ScanlineFill
+    const int rows = last - first + 1;
+    mFirstRow_ = first;
+    mRowStarts_.assign(rows + 1, 0);
+
+    for (size_t i = 0; i + 3 < lines.size(); i += 4)
+        if (span_of(i, y, span))
+            mRowStarts_[y - first + 1]++;
+
+    for (int r = 0; r < rows; r++)
+        mRowStarts_[r + 1] += mRowStarts_[r];
+
+    mSpans_.resize(mRowStarts_[rows]);
+    mCursors_.assign(mRowStarts_.begin(), mRowStarts_.end() - 1);
+
+    for (size_t i = 0; i + 3 < lines.size(); i += 4)
+        if (span_of(i, y, span))
+            mSpans_[mCursors_[y - first]++] = span;
+
+    // - fills push their spans from left to right, so the insertion sort is a single pass.
+    // Rows are then merged and packed towards the front
+    int packed = 0;
+    for (int r = 0; r < rows; r++)
+    {
+        const int begin = mRowStarts_[r];
+        const int end = mRowStarts_[r + 1];
+
+        for (int i = begin + 1; i < end; i++)
+        {
+            const Span current = mSpans_[i];
+            int j = i;
+
+            while (j > begin && current.begin < mSpans_[j - 1].begin)
+            {
+                mSpans_[j] = mSpans_[j - 1];
+                j--;
+            }
+
+            mSpans_[j] = current;
+        }
+
+        mRowStarts_[r] = packed;
+        for (int i = begin; i < end; i++)
+        {
+            if (packed > mRowStarts_[r] && mSpans_[i].begin <= mSpans_[packed - 1].end)
+                mSpans_[packed - 1].end = std::max(mSpans_[packed - 1].end, mSpans_[i].end);
+            else
+                mSpans_[packed++] = mSpans_[i];
+        }
+    }
+
+    mRowStarts_[rows] = packed;
+    mSpans_.resize(packed);
+}
+
+const SpanFill::Span* SpanFill::rowBegin(int y) const
+{
+    const int r = y - mFirstRow_;
+    if (r < 0 || r >= rows())
+        return mSpans_.data();
+
+    return mSpans_.data() + mRowStarts_[r];
+}
+
+const SpanFill::Span* SpanFill::rowEnd(int y) const
+{
+    const int r = y - mFirstRow_;
+    if (r < 0 || r >= rows())
+        return mSpans_.data();
+
+    return mSpans_.data() + mRowStarts_[r + 1];
+}
+
+bool SpanFill::contains(float x, float y) const
+{
+    const int px = int(std::floor(x));
+    const int py = int(std::floor(y));
+    const Span* begin = rowBegin(py);
+    const Span* end = rowEnd(py);
+
+    // - the last span starting at or before px is the only one that can hold it
+    const Span* after = std::upper_bound(begin, end, px, [](int value, const Span& span)
+    {
+        return value < span.begin;
+    });
+
+    return after != begin && px < (after - 1)->end;
+}
+
+long long SpanFill::area() const
+{
+    long long area = 0;
+    for (const Span& span : mSpans_)
+        area += span.end - span.begin;
+
+    return area;
+}
+
+void SpanFill::shared_rows(const SpanFill& other, int dy, int& first, int& last) const
+{
+    first = std::max(mFirstRow_, other.mFirstRow_ + dy);
+    last = std::min(mFirstRow_ + rows(), other.mFirstRow_ + dy + other.rows());
+}
+
+void SpanFill::intersect(const SpanFill& a, const SpanFill& b, int dx, int dy)
+{
+    // - the spans are written while a and b are read
+    if (this == &a || this == &b)
+    {
+        SpanFill result;
+        result.intersect(a, b, dx, dy);
+        *this = std::move(result);
+        return;
+    }
+
+    clear();
+
+    int first;
+    int last;
+    a.shared_rows(b, dy, first, last);
+
+    if (first >= last)
+        return;
+
+    mFirstRow_ = first;
+    mRowStarts_.reserve(last - first + 1);
+    mRowStarts_.push_back(0);
+
+    for (int y = first; y < last; y++)
+    {
+        const Span* i = a.rowBegin(y);
+        const Span* i_end = a.rowEnd(y);
+        const Span* j = b.rowBegin(y - dy);
+        const Span* j_end = b.rowEnd(y - dy);
+
+        // - the span ending first can't meet anything past the other one
+        while (i != i_end && j != j_end)
+        {
+            const int begin = std::max(i->begin, j->begin + dx);
+            const int end = std::min(i->end, j->end + dx);
+
+            if (begin < end)
+                mSpans_.push_back({ begin, end });
+
+            if (i->end < j->end + dx)
+                i++;
+            else
+                j++;
+        }
+
+        mRowStarts_.push_back(mSpans_.size());
+    }
+}
+
+bool SpanFill::overlaps(const SpanFill& other, int dx, int dy) const
+{
+    int first;
+    int last;
+    shared_rows(other, dy, first, last);
+
+    for (int y = first; y < last; y++)
+    {
+        const Span* i = rowBegin(y);
+        const Span* i_end = rowEnd(y);
+        const Span* j = other.rowBegin(y - dy);
+        const Span* j_end = other.rowEnd(y - dy);
+
+        while (i != i_end && j != j_end)
+        {
+            if (std::max(i->begin, j->begin + dx) < std::min(i->end, j->end + dx))
+                return true;
+
+            if (i->end < j->end + dx)
+                i++;
+            else
+                j++;
+        }
+    }
+
+    return false;
+}
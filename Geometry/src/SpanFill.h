@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+
+// - a fill kept as runs of pixels : per row, the sorted [begin, end) intervals of the
+// filled pixels, all rows in one flat array and an offset per row into it. Built from
+// the spans fill_LCA pushes, so picking, hover and overlap tests reuse the fill instead
+// of testing the geometry again. A pixel (x, y) is filled if a span of row y holds x,
+// which is what the renderers light for those spans
+class SpanFill
+{
+public:
+    struct Span
+    {
+        int begin;
+        int end;
+    };
+
+    void clear();
+    // - from spans of 2 points (4 floats) each, in any order. Empty spans are dropped and
+    // the ones touching or overlapping on a row are merged
+    void assign(const std::vector<float>& lines);
+
+    bool empty() const { return mSpans_.empty(); }
+    int firstRow() const { return mFirstRow_; }
+    int rows() const { return mRowStarts_.empty() ? 0 : int(mRowStarts_.size()) - 1; }
+    // - spans of row y, empty outside of the fill
+    const Span* rowBegin(int y) const;
+    const Span* rowEnd(int y) const;
+
+    // - whether the pixel holding the point is filled, a binary search in its row
+    bool contains(float x, float y) const;
+    // - filled pixels
+    long long area() const;
+    // - this = a and b, b being moved by (dx, dy) pixels. Row by row, both lists of
+    // spans are walked at once
+    void intersect(const SpanFill& a, const SpanFill& b, int dx = 0, int dy = 0);
+    // - same walk without keeping the spans, stopping on the first shared pixel
+    bool overlaps(const SpanFill& other, int dx = 0, int dy = 0) const;
+
+private:
+    // - rows held by both fills, other being moved by dy
+    void shared_rows(const SpanFill& other, int dy, int& first, int& last) const;
+
+    int mFirstRow_ = 0;
+    // - row y holds the spans [mRowStarts_[y - mFirstRow_], mRowStarts_[y - mFirstRow_ + 1])
+    std::vector<int> mRowStarts_;
+    std::vector<Span> mSpans_;
+    // - next free place of each row while spans are sorted into them
+    std::vector<int> mCursors_;
+};
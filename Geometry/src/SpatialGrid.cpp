@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <cmath>
+
+#include "SpatialGrid.h"
+
+// - upper bounds on the grid size, in cells per axis and cells per box
+static const int MAX_CELLS_PER_AXIS = 512;
+static const int MAX_CELLS_PER_BOX = 4;
+
+bool SpatialGrid::build(const std::vector<BoundingBox>& boxes)
+{
+    if (mColumns_ > 0 && same_boxes(boxes))
+        return false;
+
+    mBoxes_ = boxes;
+    mBounds_ = BoundingBox();
+
+    // - bounds of the whole set and average box size
+    float width = 0.0f;
+    float height = 0.0f;
+    int count = 0;
+
+    for (const auto& box : boxes)
+    {
+        if (box.empty())
+            continue;
+
+        if (mBounds_.empty())
+            mBounds_ = box;
+
+        mBounds_.x_min = std::min(mBounds_.x_min, box.x_min);
+        mBounds_.y_min = std::min(mBounds_.y_min, box.y_min);
+        mBounds_.x_max = std::max(mBounds_.x_max, box.x_max);
+        mBounds_.y_max = std::max(mBounds_.y_max, box.y_max);
+        width += box.x_max - box.x_min;
+        height += box.y_max - box.y_min;
+        count++;
+    }
+
+    mColumns_ = 1;
+    mRows_ = 1;
+
+    // - cells about the size of an average box, so a box only covers a few of them
+    if (count > 0)
+    {
+        const float extent_x = mBounds_.x_max - mBounds_.x_min;
+        const float extent_y = mBounds_.y_max - mBounds_.y_min;
+        const float average_x = std::max(width / count, 1.0f);
+        const float average_y = std::max(height / count, 1.0f);
+
+        mColumns_ = std::min(std::max(int(extent_x / average_x), 1), MAX_CELLS_PER_AXIS);
+        mRows_ = std::min(std::max(int(extent_y / average_y), 1), MAX_CELLS_PER_AXIS);
+
+        // - don't allocate more cells than there are boxes to store
+        while (mColumns_ * mRows_ > MAX_CELLS_PER_BOX * count && (mColumns_ > 1 || mRows_ > 1))
+        {
+            mColumns_ = std::max(mColumns_ / 2, 1);
+            mRows_ = std::max(mRows_ / 2, 1);
+        }
+    }
+
+    mCellWidth_ = mBounds_.empty() ? 1.0f : std::max((mBounds_.x_max - mBounds_.x_min) / mColumns_, 1e-6f);
+    mCellHeight_ = mBounds_.empty() ? 1.0f : std::max((mBounds_.y_max - mBounds_.y_min) / mRows_, 1e-6f);
+
+    // - count the boxes of every cell, then fill them
+    mCellStarts_.assign(cells() + 1, 0);
+
+    for (const auto& box : boxes)
+    {
+        if (box.empty())
+            continue;
+
+        int x0, y0, x1, y1;
+        cell_range(box, x0, y0, x1, y1);
+        for (int y = y0; y <= y1; y++)
+            for (int x = x0; x <= x1; x++)
+                mCellStarts_[y * mColumns_ + x + 1]++;
+    }
+
+    for (int c = 0; c < cells(); c++)
+        mCellStarts_[c + 1] += mCellStarts_[c];
+
+    std::vector<int> fill(mCellStarts_.begin(), mCellStarts_.end() - 1);
+    mItems_.resize(mCellStarts_.back());
+
+    for (int id = 0; id < int(boxes.size()); id++)
+    {
+        if (boxes[id].empty())
+            continue;
+
+        int x0, y0, x1, y1;
+        cell_range(boxes[id], x0, y0, x1, y1);
+        for (int y = y0; y <= y1; y++)
+            for (int x = x0; x <= x1; x++)
+                mItems_[fill[y * mColumns_ + x]++] = id;
+    }
+
+    return true;
+}
+
+void SpatialGrid::query(const BoundingBox& box, std::vector<int>& ids) const
+{
+    ids.clear();
+
+    if (!box.overlaps(mBounds_))
+        return;
+
+    int x0, y0, x1, y1;
+    cell_range(box, x0, y0, x1, y1);
+
+    for (int y = y0; y <= y1; y++)
+    {
+        for (int x = x0; x <= x1; x++)
+        {
+            const int cell = y * mColumns_ + x;
+            ids.insert(ids.end(), mItems_.begin() + mCellStarts_[cell], mItems_.begin() + mCellStarts_[cell + 1]);
+        }
+    }
+
+    // - a box covering several cells is found once per cell. Sorting also keeps the
+    // same order as a plain loop over the boxes
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+}
+
+bool SpatialGrid::same_boxes(const std::vector<BoundingBox>& boxes) const
+{
+    if (boxes.size() != mBoxes_.size())
+        return false;
+
+    for (size_t i = 0; i < boxes.size(); i++)
+    {
+        const BoundingBox& a = boxes[i];
+        const BoundingBox& b = mBoxes_[i];
+        if (a.x_min != b.x_min || a.y_min != b.y_min || a.x_max != b.x_max || a.y_max != b.y_max)
+            return false;
+    }
+
+    return true;
+}
+
+void SpatialGrid::cell_range(const BoundingBox& box, int& x0, int& y0, int& x1, int& y1) const
+{
+    x0 = int(std::floor((box.x_min - mBounds_.x_min) / mCellWidth_));
+    y0 = int(std::floor((box.y_min - mBounds_.y_min) / mCellHeight_));
+    x1 = int(std::floor((box.x_max - mBounds_.x_min) / mCellWidth_));
+    y1 = int(std::floor((box.y_max - mBounds_.y_min) / mCellHeight_));
+
+    x0 = std::min(std::max(x0, 0), mColumns_ - 1);
+    y0 = std::min(std::max(y0, 0), mRows_ - 1);
+    x1 = std::min(std::max(x1, 0), mColumns_ - 1);
+    y1 = std::min(std::max(y1, 0), mRows_ - 1);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <vector>
+
+#include "Shape.h"
+
+// - uniform grid over a set of boxes, used to find the windows (or window triangles)
+// a polygon can touch without testing all of them
+class SpatialGrid
+{
+public:
+    // - the grid is only rebuilt when the boxes differ from the previous call,
+    // returns true if it was rebuilt
+    bool build(const std::vector<BoundingBox>& boxes);
+    // - ids (sorted) of the boxes sharing a cell with box, they still may not overlap it.
+    // Can be called from several threads at once
+    void query(const BoundingBox& box, std::vector<int>& ids) const;
+    int cells() const { return mColumns_ * mRows_; }
+
+private:
+    bool same_boxes(const std::vector<BoundingBox>& boxes) const;
+    void cell_range(const BoundingBox& box, int& x0, int& y0, int& x1, int& y1) const;
+
+    std::vector<BoundingBox> mBoxes_;
+    BoundingBox mBounds_;
+    int mColumns_ = 0;
+    int mRows_ = 0;
+    float mCellWidth_ = 0.0f;
+    float mCellHeight_ = 0.0f;
+
+    // - items of cell c are mItems_[mCellStarts_[c]] .. mItems_[mCellStarts_[c + 1]]
+    std::vector<int> mCellStarts_;
+    std::vector<int> mItems_;
+};
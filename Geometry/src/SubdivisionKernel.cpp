@@ -0,0 +1,291 @@
+#include <cmath>
+
+#include "SubdivisionKernel.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SUBDIVISION_KERNEL_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SUBDIVISION_KERNEL_SSE2
+#endif
+
+#if defined(SUBDIVISION_KERNEL_AVX2)
+// - a0 b0 a1 b1 ... a7 b7 at out. unpack works inside each 128 bit half, the halves
+// are put back in order afterwards
+static inline void store_interleaved(float* out, __m256 a, __m256 b)
+{
+    const __m256 low = _mm256_unpacklo_ps(a, b);
+    const __m256 high = _mm256_unpackhi_ps(a, b);
+    _mm256_storeu_ps(out, _mm256_permute2f128_ps(low, high, 0x20));
+    _mm256_storeu_ps(out + 8, _mm256_permute2f128_ps(low, high, 0x31));
+}
+#elif defined(SUBDIVISION_KERNEL_SSE2)
+// - a0 b0 a1 b1 a2 b2 a3 b3 at out
+static inline void store_interleaved(float* out, __m128 a, __m128 b)
+{
+    _mm_storeu_ps(out, _mm_unpacklo_ps(a, b));
+    _mm_storeu_ps(out + 4, _mm_unpackhi_ps(a, b));
+}
+#endif
+
+void SubdivisionKernel::load(const float* points, int count)
+{
+    reserve(count);
+    mSize_ = count;
+
+    for (int i = 0; i < count; i++)
+    {
+        mX_[i] = points[i * 2];
+        mY_[i] = points[i * 2 + 1];
+    }
+}
+
+void SubdivisionKernel::subdivide(int levels)
+{
+    if (mSize_ == 0 || levels <= 0)
+        return;
+
+    // - the size of the last level is known, nothing is allocated past this point
+    reserve(mSize_ << levels);
+
+    for (int level = 0; level < levels; level++)
+    {
+        mX_[mSize_] = mX_[0];
+        mY_[mSize_] = mY_[0];
+
+        cut_corners(mX_.data(), mOutX_.data());
+        cut_corners(mY_.data(), mOutY_.data());
+        swap_buffers();
+    }
+}
+
+void SubdivisionKernel::subdivideAdaptive(float tolerance, float max_turn, int max_levels)
+{
+    if (mSize_ < 3)
+        return;
+
+    const float cos_max_turn = std::cos(max_turn);
+
+    for (int level = 0; level < max_levels; level++)
+    {
+        mX_[mSize_] = mX_[0];
+        mY_[mSize_] = mY_[0];
+
+        const int cuts = mark_corners(tolerance, cos_max_turn);
+        if (cuts == 0)
+            break;
+
+        // - a cut corner becomes the points a quarter of the way along both its edges,
+        // the other ones stay as they are
+        reserve(mSize_ + cuts);
+        const float* x = mX_.data();
+        const float* y = mY_.data();
+        float* out_x = mOutX_.data();
+        float* out_y = mOutY_.data();
+        int count = 0;
+
+        for (int i = 0; i < mSize_; i++)
+        {
+            if (mCut_[i] == 0)
+            {
+                out_x[count] = x[i];
+                out_y[count] = y[i];
+                count++;
+                continue;
+            }
+
+            const int prev = i == 0 ? mSize_ - 1 : i - 1;
+            out_x[count] = (x[prev] + 3.0f * x[i]) * 0.25f;
+            out_y[count] = (y[prev] + 3.0f * y[i]) * 0.25f;
+            out_x[count + 1] = (3.0f * x[i] + x[i + 1]) * 0.25f;
+            out_y[count + 1] = (3.0f * y[i] + y[i + 1]) * 0.25f;
+            count += 2;
+        }
+
+        mX_.swap(mOutX_);
+        mY_.swap(mOutY_);
+        mSize_ = count;
+    }
+}
+
+void SubdivisionKernel::fractalise(int levels)
+{
+    if (mSize_ == 0 || levels <= 0)
+        return;
+
+    reserve(mSize_ << levels);
+
+    for (int level = 0; level < levels; level++)
+    {
+        mX_[mSize_] = mX_[0];
+        mY_[mSize_] = mY_[0];
+
+        push_out();
+        swap_buffers();
+    }
+}
+
+void SubdivisionKernel::store(float* points) const
+{
+    const float* x = mX_.data();
+    const float* y = mY_.data();
+    int i = 0;
+
+#if defined(SUBDIVISION_KERNEL_AVX2)
+    for (; i + 8 <= mSize_; i += 8)
+        store_interleaved(points + i * 2, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i));
+#elif defined(SUBDIVISION_KERNEL_SSE2)
+    for (; i + 4 <= mSize_; i += 4)
+        store_interleaved(points + i * 2, _mm_loadu_ps(x + i), _mm_loadu_ps(y + i));
+#endif
+
+    for (; i < mSize_; i++)
+    {
+        points[i * 2] = x[i];
+        points[i * 2 + 1] = y[i];
+    }
+}
+
+void SubdivisionKernel::reserve(int count)
+{
+    // - room for the repeated first point
+    const size_t capacity = count + 1;
+    if (mX_.size() >= capacity)
+        return;
+
+    mX_.resize(capacity);
+    mY_.resize(capacity);
+    mOutX_.resize(capacity);
+    mOutY_.resize(capacity);
+}
+
+void SubdivisionKernel::swap_buffers()
+{
+    mX_.swap(mOutX_);
+    mY_.swap(mOutY_);
+    mSize_ *= 2;
+}
+
+// - computes the same expressions, in the same order, as the scalar code so every
+// lane gives exactly the scalar result
+void SubdivisionKernel::cut_corners(const float* p, float* out) const
+{
+    const int n = mSize_;
+    int i = 0;
+
+#if defined(SUBDIVISION_KERNEL_AVX2)
+    const __m256 v_half = _mm256_set1_ps(0.5f);
+
+    for (; i + 8 <= n; i += 8)
+    {
+        const __m256 a = _mm256_loadu_ps(p + i);
+        const __m256 b = _mm256_loadu_ps(p + i + 1);
+        const __m256 middle = _mm256_mul_ps(_mm256_add_ps(a, b), v_half);
+        store_interleaved(out + i * 2, _mm256_mul_ps(_mm256_add_ps(a, middle), v_half), _mm256_mul_ps(_mm256_add_ps(middle, b), v_half));
+    }
+#elif defined(SUBDIVISION_KERNEL_SSE2)
+    const __m128 v_half = _mm_set1_ps(0.5f);
+
+    for (; i + 4 <= n; i += 4)
+    {
+        const __m128 a = _mm_loadu_ps(p + i);
+        const __m128 b = _mm_loadu_ps(p + i + 1);
+        const __m128 middle = _mm_mul_ps(_mm_add_ps(a, b), v_half);
+        store_interleaved(out + i * 2, _mm_mul_ps(_mm_add_ps(a, middle), v_half), _mm_mul_ps(_mm_add_ps(middle, b), v_half));
+    }
+#endif
+
+    for (; i < n; i++)
+    {
+        const float middle = (p[i] + p[i + 1]) * 0.5f;
+        out[i * 2] = (p[i] + middle) * 0.5f;
+        out[i * 2 + 1] = (middle + p[i + 1]) * 0.5f;
+    }
+}
+
+void SubdivisionKernel::push_out()
+{
+    const int n = mSize_;
+    const float* x = mX_.data();
+    const float* y = mY_.data();
+    float* out_x = mOutX_.data();
+    float* out_y = mOutY_.data();
+    int i = 0;
+
+    // - the edge (dx, dy) turned by a quarter is (-dy, dx), its length is already half
+    // the edge's once scaled like the middle
+#if defined(SUBDIVISION_KERNEL_AVX2)
+    const __m256 v_half = _mm256_set1_ps(0.5f);
+
+    for (; i + 8 <= n; i += 8)
+    {
+        const __m256 x1 = _mm256_loadu_ps(x + i);
+        const __m256 y1 = _mm256_loadu_ps(y + i);
+        const __m256 x2 = _mm256_loadu_ps(x + i + 1);
+        const __m256 y2 = _mm256_loadu_ps(y + i + 1);
+        const __m256 middle_x = _mm256_mul_ps(_mm256_sub_ps(_mm256_add_ps(x1, x2), _mm256_sub_ps(y2, y1)), v_half);
+        const __m256 middle_y = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(y1, y2), _mm256_sub_ps(x2, x1)), v_half);
+        store_interleaved(out_x + i * 2, x1, middle_x);
+        store_interleaved(out_y + i * 2, y1, middle_y);
+    }
+#elif defined(SUBDIVISION_KERNEL_SSE2)
+    const __m128 v_half = _mm_set1_ps(0.5f);
+
+    for (; i + 4 <= n; i += 4)
+    {
+        const __m128 x1 = _mm_loadu_ps(x + i);
+        const __m128 y1 = _mm_loadu_ps(y + i);
+        const __m128 x2 = _mm_loadu_ps(x + i + 1);
+        const __m128 y2 = _mm_loadu_ps(y + i + 1);
+        const __m128 middle_x = _mm_mul_ps(_mm_sub_ps(_mm_add_ps(x1, x2), _mm_sub_ps(y2, y1)), v_half);
+        const __m128 middle_y = _mm_mul_ps(_mm_add_ps(_mm_add_ps(y1, y2), _mm_sub_ps(x2, x1)), v_half);
+        store_interleaved(out_x + i * 2, x1, middle_x);
+        store_interleaved(out_y + i * 2, y1, middle_y);
+    }
+#endif
+
+    for (; i < n; i++)
+    {
+        out_x[i * 2] = x[i];
+        out_y[i * 2] = y[i];
+        out_x[i * 2 + 1] = ((x[i] + x[i + 1]) - (y[i + 1] - y[i])) * 0.5f;
+        out_y[i * 2 + 1] = ((y[i] + y[i + 1]) + (x[i + 1] - x[i])) * 0.5f;
+    }
+}
+
+int SubdivisionKernel::mark_corners(float tolerance, float cos_max_turn)
+{
+    const int n = mSize_;
+    const float* x = mX_.data();
+    const float* y = mY_.data();
+    int cuts = 0;
+
+    if (mCut_.size() < size_t(n))
+        mCut_.resize(n);
+
+    for (int i = 0; i < n; i++)
+    {
+        const int prev = i == 0 ? n - 1 : i - 1;
+        const float in_x = x[i] - x[prev];
+        const float in_y = y[i] - y[prev];
+        const float out_x = x[i + 1] - x[i];
+        const float out_y = y[i + 1] - y[i];
+
+        // - the cut takes the corner to the middle of its 2 new points, (in - out) / 8 away
+        const float move_x = (in_x - out_x) * 0.125f;
+        const float move_y = (in_y - out_y) * 0.125f;
+        const bool visible = move_x * move_x + move_y * move_y > tolerance * tolerance;
+
+        // - edges shorter than the tolerance can't be seen turning anymore
+        const float in_length = std::sqrt(in_x * in_x + in_y * in_y);
+        const float out_length = std::sqrt(out_x * out_x + out_y * out_y);
+        const bool sharp = in_length > tolerance && out_length > tolerance &&
+                           in_x * out_x + in_y * out_y < cos_max_turn * in_length * out_length;
+
+        mCut_[i] = visible || sharp ? 1 : 0;
+        cuts += mCut_[i];
+    }
+
+    return cuts;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+
+// - several levels of subdivision of a closed ring at once. Points are kept in separate
+// x / y arrays sized once for the last level, each level is one vectorized pass (AVX2
+// or SSE2 when the build targets them, scalar otherwise) from one pair of arrays into
+// the other, and the result is only interleaved back at the end
+class SubdivisionKernel
+{
+public:
+    // - interleaved x, y points of the ring
+    void load(const float* points, int count);
+    // - chaikin corner cutting : every edge is replaced by the points at its quarter
+    // and three quarters, doubling the points each level
+    void subdivide(int levels);
+    // - the same corner cutting, only where it shows : a corner is cut while cutting it
+    // moves it by more than tolerance pixels, or while it turns by more than max_turn
+    // radians with both its edges longer than tolerance. Stops once no corner is cut,
+    // or after max_levels levels
+    void subdivideAdaptive(float tolerance, float max_turn, int max_levels);
+    // - after every point, the middle of its edge pushed out by half the edge's length
+    // (to the left of the edge), doubling the points each level
+    void fractalise(int levels);
+    // - interleaved x, y points of the result, size() of them
+    void store(float* points) const;
+    int size() const { return mSize_; }
+
+private:
+    void reserve(int count);
+    void swap_buffers();
+    // - one level of corner cutting on one coordinate
+    void cut_corners(const float* p, float* out) const;
+    void push_out();
+    // - flags the corners subdivideAdaptive cuts, returns how many there are
+    int mark_corners(float tolerance, float cos_max_turn);
+
+    int mSize_ = 0;
+
+    // - ring points, with the first one repeated at the end so point i + 1 always exists
+    std::vector<float> mX_;
+    std::vector<float> mY_;
+    // - output of a level, swapped with mX_ / mY_ after it
+    std::vector<float> mOutX_;
+    std::vector<float> mOutY_;
+    // - 1 / 0 per corner, cut or kept by the adaptive subdivision
+    std::vector<int> mCut_;
+};
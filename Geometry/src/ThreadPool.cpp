@@ -0,0 +1,140 @@
+#include <algorithm>
+
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int threads)
+{
+    if (threads <= 0)
+        threads = std::max(int(std::thread::hardware_concurrency()), 1);
+
+    for (int i = 0; i < threads; i++)
+        mQueues_.push_back(std::make_unique<Queue>());
+
+    // - thread 0 is the one calling parallel_for
+    for (int i = 1; i < threads; i++)
+        mWorkers_.emplace_back(&ThreadPool::work, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex_);
+        mStop_ = true;
+    }
+
+    mWake_.notify_all();
+    for (auto& worker : mWorkers_)
+        worker.join();
+}
+
+void ThreadPool::parallel_for(int count, int grain, const std::function<void(int, int, int)>& task)
+{
+    if (count <= 0)
+        return;
+
+    grain = std::max(grain, 1);
+    const int chunks = (count + grain - 1) / grain;
+
+    // - not worth waking anybody up
+    if (mWorkers_.empty() || chunks == 1)
+    {
+        task(0, count, 0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex_);
+        mTask_ = &task;
+        mCount_ = count;
+        mGrain_ = grain;
+        mPending_ = chunks;
+
+        // - every thread starts with a contiguous block of chunks
+        const int queues = mQueues_.size();
+        for (int q = 0; q < queues; q++)
+        {
+            std::lock_guard<std::mutex> queue_lock(mQueues_[q]->mutex);
+            for (int chunk = chunks * q / queues; chunk < chunks * (q + 1) / queues; chunk++)
+                mQueues_[q]->chunks.push_back(chunk);
+        }
+
+        mGeneration_++;
+    }
+
+    mWake_.notify_all();
+
+    while (run_chunk(0))
+        ;
+
+    std::unique_lock<std::mutex> lock(mMutex_);
+    mDone_.wait(lock, [this] { return mPending_ == 0; });
+    mTask_ = nullptr;
+}
+
+void ThreadPool::work(int thread)
+{
+    unsigned int generation = 0;
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mMutex_);
+            mWake_.wait(lock, [&] { return mStop_ || mGeneration_ != generation; });
+            if (mStop_)
+                return;
+
+            generation = mGeneration_;
+        }
+
+        while (run_chunk(thread))
+            ;
+    }
+}
+
+bool ThreadPool::run_chunk(int thread)
+{
+    int chunk;
+    if (!pop(thread, chunk) && !steal(thread, chunk))
+        return false;
+
+    const int begin = chunk * mGrain_;
+    (*mTask_)(begin, std::min(begin + mGrain_, mCount_), thread);
+
+    std::lock_guard<std::mutex> lock(mMutex_);
+    if (--mPending_ == 0)
+        mDone_.notify_all();
+
+    return true;
+}
+
+bool ThreadPool::pop(int thread, int& chunk)
+{
+    // - own chunks are taken from the front, in order
+    Queue& queue = *mQueues_[thread];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.chunks.empty())
+        return false;
+
+    chunk = queue.chunks.front();
+    queue.chunks.pop_front();
+    return true;
+}
+
+bool ThreadPool::steal(int thread, int& chunk)
+{
+    // - other chunks are taken from the back, far from where their owner works
+    const int queues = mQueues_.size();
+    for (int i = 1; i < queues; i++)
+    {
+        Queue& queue = *mQueues_[(thread + i) % queues];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.chunks.empty())
+            continue;
+
+        chunk = queue.chunks.back();
+        queue.chunks.pop_back();
+        return true;
+    }
+
+    return false;
+}
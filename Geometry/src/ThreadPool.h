@@ -0,0 +1,56 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// - work stealing pool used to spread loops over every core. Each thread gets its own
+// queue of chunks and steals from the others once it is empty, so a few expensive
+// chunks don't leave the other threads idle
+class ThreadPool
+{
+public:
+    // - 0 uses one thread per core, the calling thread counts as one of them
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int threads() const { return int(mWorkers_.size()) + 1; }
+    // - calls task(begin, end, thread) on chunks of grain items covering [0, count) and
+    // returns once they are all done. thread is in [0, threads()), so it can index
+    // per thread data
+    void parallel_for(int count, int grain, const std::function<void(int, int, int)>& task);
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<int> chunks;
+    };
+
+    void work(int thread);
+    bool run_chunk(int thread);
+    bool pop(int thread, int& chunk);
+    bool steal(int thread, int& chunk);
+
+    std::vector<std::thread> mWorkers_;
+    std::vector<std::unique_ptr<Queue>> mQueues_;
+
+    std::mutex mMutex_;
+    std::condition_variable mWake_;
+    std::condition_variable mDone_;
+    unsigned int mGeneration_ = 0;
+    int mPending_ = 0;
+    bool mStop_ = false;
+
+    // - current loop
+    const std::function<void(int, int, int)>* mTask_ = nullptr;
+    int mCount_ = 0;
+    int mGrain_ = 1;
+};
@@ -0,0 +1,188 @@
+#include <algorithm>
+
+#include "TrapezoidFill.h"
+
+// - slabs thinner than this are not split any further
+static const float MIN_SLAB = 1e-3f;
+
+void TrapezoidFill::fill(const std::vector<std::unique_ptr<Edge>>& edges, std::vector<float>& triangles)
+{
+    build_sides(edges);
+
+    mActive_.clear();
+    mOpenLefts_.clear();
+    mOpen_.assign(mSides_.size(), { -1, 0.0f });
+    mRightOf_.assign(mSides_.size(), -1);
+
+    if (mSides_.empty())
+        return;
+
+    size_t next_side = 0;
+    size_t next_event = 1;
+    float y = mEvents_[0];
+
+    while (next_event < mEvents_.size())
+    {
+        // - edges ending here leave, edges starting here come in
+        mActive_.erase(std::remove_if(mActive_.begin(), mActive_.end(), [this, y](int side)
+        {
+            return mSides_[side].y_max <= y;
+        }), mActive_.end());
+
+        while (next_side < mSides_.size() && mSides_[next_side].y_min <= y)
+            mActive_.push_back(next_side++);
+
+        // - the slab goes to the next event, or to the first crossing before it
+        const float next_y = end_slab(y, mEvents_[next_event]);
+        update_trapezoids(y, triangles);
+
+        y = next_y;
+        while (next_event < mEvents_.size() && mEvents_[next_event] <= y)
+            next_event++;
+    }
+
+    // - every edge ends on the last event
+    mActive_.clear();
+    update_trapezoids(y, triangles);
+}
+
+void TrapezoidFill::build_sides(const std::vector<std::unique_ptr<Edge>>& edges)
+{
+    mSides_.clear();
+    mEvents_.clear();
+
+    for (auto&& edge : edges)
+    {
+        // - horizontal edges bound nothing
+        if (edge->minY() == edge->maxY())
+            continue;
+
+        const float x = edge->y1_ < edge->y2_ ? edge->x1_ : edge->x2_;
+        mSides_.push_back({ x, edge->minY(), edge->maxY(), edge->getInvDir() });
+        mEvents_.push_back(edge->minY());
+        mEvents_.push_back(edge->maxY());
+    }
+
+    std::sort(mSides_.begin(), mSides_.end(), [](const Side& lhs, const Side& rhs)
+    {
+        return lhs.y_min < rhs.y_min;
+    });
+
+    std::sort(mEvents_.begin(), mEvents_.end());
+    mEvents_.erase(std::unique(mEvents_.begin(), mEvents_.end()), mEvents_.end());
+}
+
+float TrapezoidFill::x_at(const int side, const float y) const
+{
+    const Side& s = mSides_[side];
+    return s.x + (y - s.y_min) * s.inv_dir;
+}
+
+void TrapezoidFill::sort_active(const float y)
+{
+    // - insertion sort : the order rarely changes from one slab to the next
+    for (size_t i = 1; i < mActive_.size(); i++)
+    {
+        const int side = mActive_[i];
+        const float x = x_at(side, y);
+        size_t j = i;
+
+        while (j > 0 && x < x_at(mActive_[j - 1], y))
+        {
+            mActive_[j] = mActive_[j - 1];
+            j--;
+        }
+
+        mActive_[j] = side;
+    }
+}
+
+float TrapezoidFill::end_slab(const float y1, float y2)
+{
+    // - the edges are sorted in the middle of the slab : when two neighbours are not
+    // sorted at one of its ends, they cross in between and the slab stops there. The
+    // shorter slab is sorted again, until nothing crosses
+    for (;;)
+    {
+        sort_active((y1 + y2) * 0.5f);
+
+        if (y2 - y1 <= MIN_SLAB)
+            return y2;
+
+        float first = y2;
+
+        for (size_t i = 1; i < mActive_.size(); i++)
+        {
+            const Side& a = mSides_[mActive_[i - 1]];
+            const Side& b = mSides_[mActive_[i]];
+
+            if (a.inv_dir == b.inv_dir)
+                continue;
+
+            if (x_at(mActive_[i - 1], y1) <= x_at(mActive_[i], y1) && x_at(mActive_[i - 1], y2) <= x_at(mActive_[i], y2))
+                continue;
+
+            // - a.x + (y - a.y_min) * a.inv_dir == b.x + (y - b.y_min) * b.inv_dir
+            const double y = (double(b.x) - a.x + double(a.y_min) * a.inv_dir - double(b.y_min) * b.inv_dir) / (double(a.inv_dir) - b.inv_dir);
+
+            // - neighbours meeting at an end point of the slab don't cut it
+            if (y > y1 + MIN_SLAB && y < y2 - MIN_SLAB && y < first)
+                first = float(y);
+        }
+
+        if (first == y2)
+            return y2;
+
+        y2 = first;
+    }
+}
+
+void TrapezoidFill::update_trapezoids(const float y, std::vector<float>& triangles)
+{
+    // - pairs of the slab starting at y, even-odd like the scanline fill
+    mLefts_.clear();
+    for (size_t i = 0; i + 1 < mActive_.size(); i += 2)
+    {
+        mRightOf_[mActive_[i]] = mActive_[i + 1];
+        mLefts_.push_back(mActive_[i]);
+    }
+
+    // - trapezoids whose sides aren't paired anymore end at y
+    for (int left : mOpenLefts_)
+    {
+        if (mRightOf_[left] == mOpen_[left].right)
+            continue;
+
+        emit(left, mOpen_[left].right, mOpen_[left].y, y, triangles);
+        mOpen_[left].right = -1;
+    }
+
+    // - and new pairs start a trapezoid
+    for (int left : mLefts_)
+    {
+        if (mOpen_[left].right == -1)
+            mOpen_[left] = { mRightOf_[left], y };
+
+        mRightOf_[left] = -1;
+    }
+
+    mOpenLefts_.swap(mLefts_);
+}
+
+void TrapezoidFill::emit(const int left, const int right, const float y1, const float y2, std::vector<float>& triangles) const
+{
+    if (y2 <= y1)
+        return;
+
+    const float left1 = x_at(left, y1);
+    const float right1 = x_at(right, y1);
+    const float left2 = x_at(left, y2);
+    const float right2 = x_at(right, y2);
+
+    // - a side of zero width gives a single triangle
+    if (right1 > left1)
+        triangles.insert(triangles.end(), { left1, y1, right1, y1, right2, y2 });
+
+    if (right2 > left2)
+        triangles.insert(triangles.end(), { left1, y1, right2, y2, left2, y2 });
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Edge.h"
+
+// - even-odd fill as trapezoids between two edges, each one cut into 2 triangles. The
+// sweep only stops where the set of edges changes (end points and crossings), and a
+// trapezoid keeps growing as long as the same two edges bound it, so the output is
+// proportional to the number of edges, not to the height of the shape in pixels
+class TrapezoidFill
+{
+public:
+    // - each triangle is pushed as 3 points (6 floats), ready to be drawn as triangles
+    void fill(const std::vector<std::unique_ptr<Edge>>& edges, std::vector<float>& triangles);
+
+private:
+    // - non horizontal edge, x is taken at y_min
+    struct Side
+    {
+        float x;
+        float y_min;
+        float y_max;
+        float inv_dir;
+    };
+
+    // - trapezoid being built on the left side : its right side and where it started
+    struct Open
+    {
+        int right;
+        float y;
+    };
+
+    void build_sides(const std::vector<std::unique_ptr<Edge>>& edges);
+    float x_at(int side, float y) const;
+    void sort_active(float y);
+    // - sorts the active edges and returns where the slab starting at y1 ends : y2, or
+    // the first crossing of two of them before it
+    float end_slab(float y1, float y2);
+    void update_trapezoids(float y, std::vector<float>& triangles);
+    void emit(int left, int right, float y1, float y2, std::vector<float>& triangles) const;
+
+    // - sides sorted by y_min, and the sorted distinct y of their end points
+    std::vector<Side> mSides_;
+    std::vector<float> mEvents_;
+    // - sides crossing the current slab, ordered by x
+    std::vector<int> mActive_;
+    // - per side : the trapezoid it bounds on the left, and its right side in the current slab
+    std::vector<Open> mOpen_;
+    std::vector<int> mRightOf_;
+    // - left sides of the trapezoids open
+    std::vector<int> mOpenLefts_;
+    std::vector<int> mLefts_;
+};
@@ -1,6 +1,6 @@
 #pragma once
 
-#include "Polygon.h"
+#include "Shape.h"
 
 class Vector
 {
@@ -87,7 +87,7 @@ int main(void)
 		renderer.clear();
 
         PolygonManager::get()->update_triangles();
-        PolygonManager::get()->sutherland_ogdmann();
+        PolygonManager::get()->clip();
         PolygonManager::get()->compute_bounding_box();
         PolygonManager::get()->on_render(vp, shader.get());
         PolygonManager::get()->on_render_fill(vp, shader.get());
@@ -103,6 +103,10 @@ int main(void)
         ImGui::BulletText("S pour subdiviser la forme actuelle.");
         ImGui::BulletText("R pour fractaliser la forme actuelle");
 		ImGui::EndChild();
+        ImGui::SliderInt("Subdivision levels", &PolygonManager::get()->subdivision_levels, 1, 8);
+        ImGui::Checkbox("Adaptive subdivision", &PolygonManager::get()->enable_adaptive_subdivision);
+        ImGui::SliderFloat("Subdivision tolerance (pixels)", &PolygonManager::get()->subdivision_tolerance, 0.1f, 4.0f);
+        ImGui::SliderFloat("Subdivision max turn (degrees)", &PolygonManager::get()->subdivision_max_turn, 1.0f, 45.0f);
 		ImGui::Text("Polygon:");
 		ImGui::BeginChild("Polygon", ImVec2(0, 150), true);
         PolygonManager::get()->on_im_gui_render_polygons();
@@ -112,8 +116,31 @@ int main(void)
         PolygonManager::get()->on_im_gui_render_windows();
 		ImGui::EndChild();
         ImGui::Text("Debug:");
-        ImGui::Checkbox("Show triangulation", &PolygonManager::get()->enable_triangulation);
+        ImGui::Checkbox("Show triangulation (convex windows are clipped whole)", &PolygonManager::get()->enable_triangulation);
         ImGui::Checkbox("Show clipping bounding box", &PolygonManager::get()->enable_bb);
+        ImGui::Checkbox("Clip concave windows directly", &PolygonManager::get()->enable_concave_clipping);
+        ImGui::Checkbox("Clip on every core", &PolygonManager::get()->enable_parallel_clipping);
+        ImGui::Checkbox("Exact clipping on the pixel grid", &PolygonManager::get()->enable_exact_clipping);
+        ImGui::Checkbox("Boolean operation between polygons and windows", &PolygonManager::get()->enable_boolean_operation);
+        ImGui::Combo("Operation", &PolygonManager::get()->selected_operation, "Union\0Intersection\0Difference\0Xor\0");
+        ImGui::Checkbox("Fill with trapezoids", &PolygonManager::get()->enable_trapezoid_fill);
+        ImGui::Checkbox("Fill on every core", &PolygonManager::get()->enable_parallel_fill);
+        ImGui::Checkbox("Anti-aliased fill on the CPU", &PolygonManager::get()->enable_antialiased_fill);
+        if (ImGui::Button("Render on the CPU to scene.ppm"))
+        {
+            SoftwareRenderer software(WIDTH, HEIGHT);
+            software.clear(0.0f, 0.0f, 0.0f, 1.0f);
+            PolygonManager::get()->on_render_software(software);
+            software.writePPM("scene.ppm");
+        }
+        ImGui::Text("Clipped pairs: %d / %d", PolygonManager::get()->get_clip_stats().clipped, PolygonManager::get()->get_clip_stats().tested);
+        ImGui::Text("Polygons clipped again: %d", PolygonManager::get()->get_clip_stats().recomputed);
+        const ImVec2 mouse = ImGui::GetIO().MousePos;
+        const auto hovered = PolygonManager::get()->get_result_at(mouse.x, mouse.y);
+        if (hovered != nullptr)
+            ImGui::Text("Result under the cursor: %lld pixels", hovered->spans().area());
+        else
+            ImGui::Text("Result under the cursor: none");
         ImGui::End();
 
 
@@ -193,23 +220,26 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
             PolygonManager::get()->delete_current_window();
             PolygonManager::get()->set_last_entry(tmp_entry);
         }
+        // - its triangles are computed by update_triangles with the next frame
         else
-        {
-            if (PolygonManager::get()->get_current_window())
-                PolygonManager::get()->get_current_window()->ear_clipping(PolygonManager::get()->get_triangles());
             PolygonManager::get()->set_last_entry(false);
-        }
     }
 
     if (key == GLFW_KEY_S && action == GLFW_PRESS)
     {
-        if (PolygonManager::get()->get_current_shape() != nullptr)
-            PolygonManager::get()->get_current_shape()->subdivise();
+        PolygonManager* manager = PolygonManager::get();
+        if (manager->get_current_shape() != nullptr)
+        {
+            if (manager->enable_adaptive_subdivision)
+                manager->get_current_shape()->subdiviseAdaptive(manager->subdivision_tolerance, glm::radians(manager->subdivision_max_turn), manager->subdivision_levels);
+            else
+                manager->get_current_shape()->subdivise(manager->subdivision_levels);
+        }
     }
 
     if (key == GLFW_KEY_R && action == GLFW_PRESS)
     {
         if (PolygonManager::get()->get_current_shape() != nullptr)
-            PolygonManager::get()->get_current_shape()->fractalise();
+            PolygonManager::get()->get_current_shape()->fractalise(PolygonManager::get()->subdivision_levels);
     }
 }
@@ -1,28 +1,48 @@
 #include "IndexBuffer.h"
 
 #include "Renderer.h"
+#include <GL/glew.h>
 
 IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
-	: m_Count(count)
+	:mCount_(count), mCapacity_(count)
 {
 	ASSERT(sizeof(unsigned int) == sizeof(GLuint));
 
-	GLCall(glGenBuffers(1, &m_RendererID));
-	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
-	GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW));
+	GL_CALL(glGenBuffers(1, &mRendererId_));
+	GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mRendererId_));
+	GL_CALL(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_DYNAMIC_DRAW));
 }
 
 IndexBuffer::~IndexBuffer()
 {
-	GLCall(glDeleteBuffers(1, &m_RendererID));
+	GL_CALL(glDeleteBuffers(1, &mRendererId_));
 }
 
-void IndexBuffer::Bind() const
+void IndexBuffer::bind() const
 {
-	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
+	GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mRendererId_));
 }
 
-void IndexBuffer::Unbind() const
+void IndexBuffer::unbind() const
 {
-	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+	GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+}
+
+void IndexBuffer::edit(const unsigned int* data, unsigned int count)
+{
+	GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mRendererId_));
+
+	if (count > mCapacity_)
+	{
+		GL_CALL(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_DYNAMIC_DRAW));
+		mCapacity_ = count;
+	}
+	// - GL_CALL expands to several statements
+	else if (count > 0)
+	{
+		GL_CALL(glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, count * sizeof(unsigned int), data));
+	}
+
+	mCount_ = count;
+	GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
 }
@@ -3,14 +3,17 @@
 class IndexBuffer
 {
 private:
-	unsigned int m_RendererID;
-	unsigned int m_Count;
+	unsigned int mRendererId_;
+	unsigned int mCount_;
+	// - indices allocated on the gpu, edits that fit are written in place
+	unsigned int mCapacity_;
 public:
 	IndexBuffer(const unsigned int* data, unsigned int count);
 	~IndexBuffer();
 
-	void Bind() const;
-	void Unbind() const;
+	void bind() const;
+	void unbind() const;
+	void edit(const unsigned int* data, unsigned int count);
 
-	inline unsigned int GetCount() const { return m_Count; }
+	unsigned int count() const { return mCount_; }
 };
\ No newline at end of file
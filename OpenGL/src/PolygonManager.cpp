@@ -1,221 +1,548 @@
-#include "PolygonManager.h"
-
-PolygonManager* PolygonManager::_instance = nullptr;
-
-PolygonManager* PolygonManager::get()
-{
-    if (!_instance)
-        _instance = new PolygonManager();
-
-    return _instance;
-}
-
-void PolygonManager::add_polygon()
-{
-    _polygons.push_back(std::make_shared<Polygon>(Polygon(1.0f, 0.0f, 0.0f, _polygon_id)));
-    _current_polygon_index++;
-    _is_last_entry_polygon = true;
-    _polygon_id++;
-}
-
-void PolygonManager::add_window()
-{
-    _windows.push_back(std::make_shared<Polygon>(Polygon(0.0f, 0.0f, 1.0f, _polygon_id)));
-    _current_window_index++;
-    _is_last_entry_polygon = false;
-    _polygon_id++;
-}
-
-void PolygonManager::on_im_gui_render_polygons()
-{
-    for (const auto& polygon : _polygons)
-        if (polygon != nullptr)
-            polygon->onImGuiRenderPolygon();
-}
-
-void PolygonManager::on_im_gui_render_windows()
-{
-    for (const auto& window : _windows)
-        if (window != nullptr)
-            window->onImGuiRenderWindow();
-}
-
-std::shared_ptr<Polygon> PolygonManager::get_current_polygon()
-{
-    if (_current_polygon_index == -1)
-        return nullptr;
-
-    return _polygons.at(_current_polygon_index);
-}
-
-std::shared_ptr<Polygon> PolygonManager::get_current_result()
-{
-    if (_current_polygon_index == -1)
-        return nullptr;
-
-    return _results.at(_current_polygon_index);
-}
-
-std::shared_ptr<Polygon> PolygonManager::get_current_window()
-{
-    if (_current_window_index == -1)
-        return nullptr;
-
-    return _windows.at(_current_window_index);
-}
-
-std::vector<std::shared_ptr<Polygon>>& PolygonManager::get_triangles()
-{
-    return _windows_triangles;
-}
-
-void PolygonManager::on_render(const glm::mat4& vp, Shader* shader)
-{
-    for (const auto& polygon : _polygons)
-        polygon->onRender(vp, shader);
-
-
-    for (const auto& window : _windows)
-        window->onRender(vp, shader);
-
-
-    if (enable_triangulation)
-        for (const auto& triangle : _windows_triangles)
-            triangle->onRender(vp, shader);
-
-    if (enable_bb)
-        for (const auto& bounding_box : _bounding_boxes)
-            bounding_box->onRender(vp, shader);
-    
-
-    for (const auto& result : _results)
-            result->onRender(vp, shader);    
-}
-
-void PolygonManager::sutherland_ogdmann()
-{
-    if (_current_window_index == -1)
-        return;
-
-    int i = 0;
-
-    _results.resize(_windows_triangles.size() * _polygons.size());
-
-    for (const auto& polygon : _polygons)
-    {
-        for (const auto& triangle : _windows_triangles)
-        {
-            if (_results[i] == nullptr)
-                _results[i] = std::make_shared<Polygon>(Polygon(0.0f, 1.0f, 0.0f));
-            _results[i]->sutherlandOgdmann(polygon, triangle);
-            i++;
-        }
-    }
-}
-
-void PolygonManager::compute_bounding_box()
-{
-    int i = 0;
-    const int size = _windows_triangles.size() * _polygons.size();
-
-    _bounding_boxes.resize(size);
-
-    if (size == 0)
-        return;
-
-    for (const auto& result : _results)
-    {
-        if (_bounding_boxes[i] == nullptr)
-            _bounding_boxes[i] = std::make_shared<Polygon>(Polygon(1.0f, 1.0f, 0.0f));
-        result->computeBoundingBox(_bounding_boxes[i]);
-        i++;
-    }
-}
-
-
-void PolygonManager::on_render_fill(const glm::mat4& vp, Shader* shader)
-{
-    for (const auto& result : _results)
-        result->onRenderFill(vp, shader);
-}
-
-void PolygonManager::delete_polygon(Polygon* p)
-{
-    if (p == nullptr)
-        return;
-    // can't use std::find as we can't compare smart and raw ptr 
-
-    std::shared_ptr<Polygon> ptr = nullptr;
-
-    for (const auto& polygon : _polygons)
-        if (polygon.get() == p)
-            ptr = polygon;
-
-    if (ptr == nullptr)
-        return;
-
-    const auto it = std::find(_polygons.begin(), _polygons.end(), ptr);
-    _polygons.erase(it);
-    _current_polygon_index--;
-}
-
-
-void PolygonManager::delete_window(Polygon* p)
-{
-    if (p == nullptr)
-        return;
-    // can't use std::find as we can't compare smart and raw ptr 
-
-    std::shared_ptr<Polygon> ptr = nullptr;
-
-    for (const auto& polygon : _windows)
-        if (polygon.get() == p)
-            ptr = polygon;
-
-    if (ptr == nullptr)
-        return;
-
-    const auto it = std::find(_windows.begin(), _windows.end(), ptr);
-    _windows.erase(it);
-    _current_window_index--;
-}
-
-void PolygonManager::update_triangles()
-{
-    // invalidate results and bounding box
-    _windows_triangles.clear();
-    _results.clear();
-    _bounding_boxes.clear();
-
-    for (auto const& window: _windows)
+#include <algorithm>
+
+#include "PolygonManager.h"
+
+PolygonManager* PolygonManager::_instance = nullptr;
+
+// - fnv-1a over the points and contour ends, in the shape's own coordinates
+static unsigned long long hash_points(const Shape& shape)
+{
+    unsigned long long hash = 14695981039346656037ull;
+    auto add = [&hash](const void* data, size_t size)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++)
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+    };
+
+    add(shape.points().data(), shape.points().size() * sizeof(float));
+    add(shape.contourEnds().data(), shape.contourEnds().size() * sizeof(int));
+    return hash;
+}
+
+// - the triangles of a window as shapes of their own for clipping, in its coordinates
+static void build_triangles(const Shape& window, const std::vector<int>& indices, std::vector<Shape>& triangles)
+{
+    const std::vector<float>& points = window.points();
+    triangles.resize(indices.size() / 3);
+
+    for (size_t i = 0; i < triangles.size(); i++)
+    {
+        const int* corners = &indices[i * 3];
+        const float triangle[6] = {
+            points[corners[0] * 2], points[corners[0] * 2 + 1],
+            points[corners[1] * 2], points[corners[1] * 2 + 1],
+            points[corners[2] * 2], points[corners[2] * 2 + 1]
+        };
+
+        triangles[i].clear();
+        triangles[i].addPoints(triangle, 3);
+    }
+}
+
+PolygonManager* PolygonManager::get()
+{
+    if (!_instance)
+        _instance = new PolygonManager();
+
+    return _instance;
+}
+
+void PolygonManager::add_polygon()
+{
+    _polygons.push_back(std::make_shared<Polygon>(Polygon(1.0f, 0.0f, 0.0f, _polygon_id)));
+    _current_polygon_index++;
+    _is_last_entry_polygon = true;
+    _polygon_id++;
+}
+
+void PolygonManager::add_window()
+{
+    _windows.push_back(std::make_shared<Polygon>(Polygon(0.0f, 0.0f, 1.0f, _polygon_id)));
+    _current_window_index++;
+    _is_last_entry_polygon = false;
+    _polygon_id++;
+}
+
+void PolygonManager::on_im_gui_render_polygons()
+{
+    for (const auto& polygon : _polygons)
+        if (polygon != nullptr)
+            polygon->onImGuiRenderPolygon();
+}
+
+void PolygonManager::on_im_gui_render_windows()
+{
+    for (const auto& window : _windows)
         if (window != nullptr)
-            window->ear_clipping(get()->get_triangles());
-}
-
-
-
-void PolygonManager::delete_current_polygon()
-{
-    if (_current_polygon_index == -1)
-        return;
-
-    _polygons.pop_back();
-    _current_polygon_index--;
-}
-
-void PolygonManager::delete_current_window()
-{
-    if (_current_window_index == -1)
-        return;
-
-    _windows.pop_back();
-    _current_window_index--;
-}
-
-std::shared_ptr<Polygon> PolygonManager::get_current_shape()
-{
-    if (_is_last_entry_polygon)
-        return get_current_polygon();
-
-    return get_current_window();
+            window->onImGuiRenderWindow();
+}
+
+std::shared_ptr<Polygon> PolygonManager::get_current_polygon()
+{
+    if (_current_polygon_index == -1)
+        return nullptr;
+
+    return _polygons.at(_current_polygon_index);
+}
+
+std::shared_ptr<Polygon> PolygonManager::get_current_result()
+{
+    if (_current_polygon_index == -1)
+        return nullptr;
+
+    return _results.at(_current_polygon_index);
+}
+
+std::shared_ptr<Polygon> PolygonManager::get_current_window()
+{
+    if (_current_window_index == -1)
+        return nullptr;
+
+    return _windows.at(_current_window_index);
+}
+
+void PolygonManager::on_render(const glm::mat4& vp, Shader* shader)
+{
+    for (const auto& polygon : _polygons)
+        polygon->onRender(vp, shader);
+
+
+    for (const auto& window : _windows)
+        window->onRender(vp, shader);
+
+
+    if (enable_triangulation)
+        for (const auto& window : _windows)
+            window->onRenderTriangles(vp, shader);
+
+    if (enable_bb)
+        for (const auto& bounding_box : _bounding_boxes)
+            bounding_box->onRender(vp, shader);
+    
+
+    for (const auto& result : _results)
+            result->onRender(vp, shader);    
+}
+
+void PolygonManager::clip()
+{
+
+    if (enable_boolean_operation)
+        boolean_operation(BooleanOperation(selected_operation));
+    else if (enable_concave_clipping)
+        greiner_hormann();
+    else
+        sutherland_ogdmann();
+}
+
+void PolygonManager::sutherland_ogdmann()
+{
+    // - one result per polygon / window pair too, the triangle fragments are joined
+    _clip_stage.setGroups(_convex_clipper_windows);
+    clip_pairs(_convex_clippers, false);
+}
+
+void PolygonManager::greiner_hormann()
+{
+    // - one result per polygon / window pair, no matter how concave the window is.
+    // Convex windows still go through sutherland-hodgman
+    _clip_stage.setGroups({});
+
+    _clip_clippers.clear();
+    for (const auto& window : _windows)
+        _clip_clippers.push_back(window.get());
+
+    clip_pairs(_clip_clippers, true);
+}
+
+void PolygonManager::boolean_operation(BooleanOperation operation)
+{
+    _clip_stats = ClipStats();
+
+    // - only computed again when the operation, a polygon or a window changed, or when
+    // clipping replaced the result in between
+    std::vector<unsigned long long> inputs;
+    inputs.push_back(static_cast<unsigned long long>(operation));
+    inputs.push_back(_polygons.size());
+    for (const auto& polygon : _polygons)
+        inputs.push_back(polygon->revision());
+    for (const auto& window : _windows)
+        inputs.push_back(window->revision());
+
+    const bool kept = _results.empty() ? _boolean_result_revision == 0 : _results.size() == 1 && _results[0]->revision() == _boolean_result_revision;
+    if (kept && inputs == _boolean_inputs)
+        return;
+
+    _clip_polygons.clear();
+    for (const auto& polygon : _polygons)
+        _clip_polygons.push_back(polygon.get());
+
+    _clip_clippers.clear();
+    for (const auto& window : _windows)
+        _clip_clippers.push_back(window.get());
+
+    if (_results.empty())
+        _results.push_back(std::make_shared<Polygon>(Polygon(0.0f, 1.0f, 0.0f)));
+    _results.resize(1);
+    _results[0]->booleanOperation(_clip_polygons, _clip_clippers, operation);
+
+    if (_results[0]->size() == 0)
+        _results.clear();
+
+    _boolean_result_revision = _results.empty() ? 0 : _results[0]->revision();
+    _boolean_inputs.swap(inputs);
+
+    // - every pair result is uploaded again once clipping comes back
+    _result_revisions.clear();
+}
+
+void PolygonManager::clip_pairs(const std::vector<const Shape*>& clippers, bool concave)
+{
+    if (_current_window_index == -1)
+    {
+        _results.clear();
+        _result_revisions.clear();
+        _clip_stats = ClipStats();
+        return;
+    }
+
+    _clip_polygons.clear();
+    for (const auto& polygon : _polygons)
+        _clip_polygons.push_back(polygon.get());
+
+    if (enable_parallel_clipping && _clip_pool == nullptr)
+        _clip_pool = std::make_unique<ThreadPool>();
+
+    _clip_stage.setExact(enable_exact_clipping);
+    _clip_stage.run(_clip_polygons, clippers, concave, enable_parallel_clipping ? _clip_pool.get() : nullptr);
+    _clip_stats.tested = _clip_stage.tested();
+    _clip_stats.clipped = _clip_stage.clipped();
+    _clip_stats.recomputed = _clip_stage.recomputed();
+
+    // - GL buffers can only be touched here, on the render thread. Only the results
+    // clipped again are uploaded
+    const int count = _clip_stage.size();
+    _result_revisions.resize(count);
+
+    for (int i = 0; i < count; i++)
+    {
+        if (i == int(_results.size()))
+            _results.push_back(std::make_shared<Polygon>(Polygon(0.0f, 1.0f, 0.0f)));
+
+        const Shape& result = _clip_stage.result(i);
+        if (_result_revisions[i] == result.revision())
+            continue;
+
+        // - clipped again to the same points (a window moved without changing this
+        // part) : keep the polygon as it is, with its buffers and fill
+        _result_revisions[i] = result.revision();
+        if (_results[i]->points() == result.points() && _results[i]->contourEnds() == result.contourEnds())
+            continue;
+
+        _results[i]->setContours(result.points(), result.contourEnds());
+    }
+
+    _results.resize(count);
+}
+
+void PolygonManager::compute_bounding_box()
+{
+    int i = 0;
+    const int size = _results.size();
+
+    _bounding_boxes.resize(size);
+
+    if (size == 0)
+        return;
+
+    _bounding_box_revisions.resize(size);
+
+    for (const auto& result : _results)
+    {
+        if (_bounding_boxes[i] == nullptr)
+        {
+            _bounding_boxes[i] = std::make_shared<Polygon>(Polygon(1.0f, 1.0f, 0.0f));
+            _bounding_box_revisions[i] = 0;
+        }
+
+        // - the box only changes with its result
+        if (_bounding_box_revisions[i] != result->revision())
+        {
+            result->computeBoundingBox(*_bounding_boxes[i]);
+            _bounding_box_revisions[i] = result->revision();
+        }
+
+        i++;
+    }
+}
+
+
+void PolygonManager::on_render_fill(const glm::mat4& vp, Shader* shader)
+{
+    // - results whose fill is stale are filled together, then uploaded here on the
+    // render thread
+    _fill_shapes.clear();
+    _fill_results.clear();
+
+    for (const auto& result : _results)
+    {
+        if (!result->fillStale(enable_trapezoid_fill))
+            continue;
+
+        _fill_shapes.push_back(result.get());
+        _fill_results.push_back(result.get());
+    }
+
+    if (enable_parallel_fill && _clip_pool == nullptr)
+        _clip_pool = std::make_unique<ThreadPool>();
+
+    if (!_fill_shapes.empty())
+    {
+        _fill_stage.run(_fill_shapes, enable_trapezoid_fill, enable_parallel_fill ? _clip_pool.get() : nullptr);
+
+        for (size_t i = 0; i < _fill_results.size(); i++)
+            _fill_results[i]->setFill(_fill_stage.vertices(i), enable_trapezoid_fill);
+    }
+
+    for (const auto& result : _results)
+        result->onRenderFill(vp, shader, enable_trapezoid_fill);
+}
+
+void PolygonManager::on_render_software(SoftwareRenderer& renderer)
+{
+    // - outlines, then fills, in the order the gpu draws them
+    std::vector<std::shared_ptr<Polygon>> outlines(_polygons);
+    outlines.insert(outlines.end(), _windows.begin(), _windows.end());
+
+    for (const auto& shape : outlines)
+        if (shape != nullptr)
+            renderer.drawOutline(*shape, shape->color());
+
+    if (enable_triangulation)
+    {
+        static const float triangle_color[4] = { 1.0f, 0.5f, 1.0f, 1.0f };
+        for (const auto& cache : _triangle_cache)
+            for (const Shape& triangle : cache.triangles)
+                renderer.drawOutline(triangle, triangle_color);
+    }
+
+    outlines.clear();
+    if (enable_bb)
+        outlines.insert(outlines.end(), _bounding_boxes.begin(), _bounding_boxes.end());
+
+    outlines.insert(outlines.end(), _results.begin(), _results.end());
+
+    for (const auto& shape : outlines)
+        if (shape != nullptr)
+            renderer.drawOutline(*shape, shape->color());
+
+    std::vector<float> vertices;
+    CoverageMask mask;
+    for (const auto& result : _results)
+    {
+        vertices.clear();
+        if (enable_antialiased_fill)
+        {
+            result->fillCoverage(mask);
+            renderer.drawCoverage(mask, result->translation(), result->color());
+        }
+        else if (enable_trapezoid_fill)
+        {
+            result->fillTrapezoids(vertices);
+            renderer.drawTriangles(vertices, result->translation(), result->color());
+        }
+        else
+        {
+            result->fill_LCA(vertices);
+            renderer.drawLines(vertices, result->translation(), result->color());
+        }
+    }
+
+    if (enable_parallel_fill && _clip_pool == nullptr)
+        _clip_pool = std::make_unique<ThreadPool>();
+
+    renderer.flush(enable_parallel_fill ? _clip_pool.get() : nullptr);
+}
+
+void PolygonManager::delete_polygon(Polygon* p)
+{
+    if (p == nullptr)
+        return;
+    // can't use std::find as we can't compare smart and raw ptr 
+
+    std::shared_ptr<Polygon> ptr = nullptr;
+
+    for (const auto& polygon : _polygons)
+        if (polygon.get() == p)
+            ptr = polygon;
+
+    if (ptr == nullptr)
+        return;
+
+    const auto it = std::find(_polygons.begin(), _polygons.end(), ptr);
+    _polygons.erase(it);
+    _current_polygon_index--;
+}
+
+
+void PolygonManager::delete_window(Polygon* p)
+{
+    if (p == nullptr)
+        return;
+    // can't use std::find as we can't compare smart and raw ptr 
+
+    std::shared_ptr<Polygon> ptr = nullptr;
+
+    for (const auto& polygon : _windows)
+        if (polygon.get() == p)
+            ptr = polygon;
+
+    if (ptr == nullptr)
+        return;
+
+    const auto it = std::find(_windows.begin(), _windows.end(), ptr);
+    _windows.erase(it);
+    _current_window_index--;
+}
+
+void PolygonManager::update_triangles()
+{
+    // - triangles are only needed by sutherland-hodgman and the debug view
+    if (enable_concave_clipping && !enable_triangulation)
+    {
+        _triangle_cache.clear();
+        _convex_clippers.clear();
+        _convex_clipper_windows.clear();
+        return;
+    }
+
+    // - only the windows whose points changed are triangulated again. Convex ones are
+    // too, for the debug view, but sutherland-hodgman clips against them whole.
+    // Triangles are in the window's own coordinates and follow its translation, so
+    // moving a window or deleting another one reuses them
+    _previous_triangle_cache.swap(_triangle_cache);
+    _triangle_cache.clear();
+    bool changed = _previous_triangle_cache.size() != _windows.size();
+
+    for (size_t i = 0; i < _windows.size(); i++)
+    {
+        const auto& window = _windows[i];
+        WindowTriangles* found = nullptr;
+
+        if (i < _previous_triangle_cache.size() && _previous_triangle_cache[i].window == window.get() &&
+            _previous_triangle_cache[i].points_revision == window->pointsRevision())
+            found = &_previous_triangle_cache[i];
+
+        const unsigned long long hash = found != nullptr ? found->hash : hash_points(*window);
+
+        // - moved out entries have no window anymore. The points are compared too, two
+        // different shapes can share a hash
+        for (size_t j = 0; found == nullptr && j < _previous_triangle_cache.size(); j++)
+        {
+            const WindowTriangles& entry = _previous_triangle_cache[j];
+            if (entry.window != nullptr && entry.hash == hash && entry.points == window->points() &&
+                entry.contour_ends == window->contourEnds())
+                found = &_previous_triangle_cache[j];
+        }
+
+        _triangle_cache.emplace_back();
+        WindowTriangles& cache = _triangle_cache.back();
+
+        if (found != nullptr)
+        {
+            // - the clippers are listed again if a window took the triangles of another one
+            if (found->window != window.get() || i >= _previous_triangle_cache.size() || found != &_previous_triangle_cache[i])
+                changed = true;
+
+            cache = std::move(*found);
+            found->window = nullptr;
+        }
+        else
+        {
+            cache.points = window->points();
+            cache.contour_ends = window->contourEnds();
+
+            // - convex windows are triangulated too for the debug view, but clipped whole
+            window->triangulate(cache.indices);
+            build_triangles(*window, cache.indices, cache.triangles);
+            changed = true;
+        }
+
+        cache.window = window.get();
+        cache.points_revision = window->pointsRevision();
+        cache.hash = hash;
+
+        // - the window draws the same indices over its own vertices
+        if (window->trianglesStale())
+            window->setTriangles(cache.indices);
+
+        // - a new translation only moves the triangles, the pairs using them are clipped again
+        const float* tr = window->translation();
+        for (Shape& triangle : cache.triangles)
+            if (triangle.translation()[0] != tr[0] || triangle.translation()[1] != tr[1])
+                triangle.setTranslation(tr[0], tr[1]);
+    }
+
+    _previous_triangle_cache.clear();
+
+    // - unchanged windows keep the same triangles, so their pairs are not clipped again
+    if (!changed)
+        return;
+
+    _convex_clippers.clear();
+    _convex_clipper_windows.clear();
+
+    for (size_t i = 0; i < _windows.size(); i++)
+    {
+        if (_windows[i]->convex())
+            _convex_clippers.push_back(_windows[i].get());
+        else
+            for (const Shape& triangle : _triangle_cache[i].triangles)
+                _convex_clippers.push_back(&triangle);
+
+        _convex_clipper_windows.resize(_convex_clippers.size(), i);
+    }
+}
+
+
+
+void PolygonManager::delete_current_polygon()
+{
+    if (_current_polygon_index == -1)
+        return;
+
+    _polygons.pop_back();
+    _current_polygon_index--;
+}
+
+void PolygonManager::delete_current_window()
+{
+    if (_current_window_index == -1)
+        return;
+
+    _windows.pop_back();
+    _current_window_index--;
+}
+
+std::shared_ptr<Polygon> PolygonManager::get_result_at(float x, float y)
+{
+    // - the last result drawn is the one on top
+    for (auto it = _results.rbegin(); it != _results.rend(); ++it)
+    {
+        Polygon& result = **it;
+        const float* tr = result.translation();
+        if (result.spans().contains(x - tr[0], y - tr[1]))
+            return *it;
+    }
+
+    return nullptr;
+}
+
+std::shared_ptr<Polygon> PolygonManager::get_current_shape()
+{
+    if (_is_last_entry_polygon)
+        return get_current_polygon();
+
+    return get_current_window();
 }
\ No newline at end of file
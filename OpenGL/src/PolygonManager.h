@@ -1,55 +1,144 @@
-#pragma once
-
-#include <memory>
-#include <vector>
-
-#include "Polygon.h"
-
-class PolygonManager
-{
-    public:
-        ~PolygonManager() { delete _instance; };
-
-        static PolygonManager* get();
-
-        void add_polygon();
-        void add_window();
-        std::shared_ptr<Polygon> get_current_polygon();
-        std::shared_ptr<Polygon> get_current_result();
-        std::shared_ptr<Polygon> get_current_window();
-        std::vector<std::shared_ptr<Polygon>>& get_triangles();
-        void on_im_gui_render_polygons();
-        void on_im_gui_render_windows();
-        void on_render(const glm::mat4& vp, Shader* shader);
-        void on_render_fill(const glm::mat4& vp, Shader* shader);
-        void compute_bounding_box();
-        void sutherland_ogdmann();
-        void delete_current_polygon();
-        void delete_polygon(Polygon* p);
-        void delete_window(Polygon* p);
-        void delete_current_window();
-        void set_last_entry(bool b) { _is_last_entry_polygon = b; }
-        bool get_last_entry() { return _is_last_entry_polygon;  }
-        std::shared_ptr<Polygon> get_current_shape();
-        void update_triangles();
-
-        bool enable_triangulation = false;
-        bool enable_bb = false;
-    
-    private:
-        PolygonManager() = default;
-
-        static PolygonManager* _instance;
-
-        int _current_polygon_index = -1;
-        int _current_window_index = -1;
-        unsigned int _polygon_id = 0;
-
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "ClipStage.h"
+#include "FillStage.h"
+#include "SoftwareRenderer.h"
+#include "Polygon.h"
+#include "ThreadPool.h"
+
+struct ClipStats
+{
+    // - polygon / window pairs going through the broad phase, and the ones really clipped
+    int tested = 0;
+    int clipped = 0;
+    // - polygons clipped again this frame, the others kept their results
+    int recomputed = 0;
+};
+
+class PolygonManager
+{
+    public:
+        ~PolygonManager() { delete _instance; };
+
+        static PolygonManager* get();
+
+        void add_polygon();
+        void add_window();
+        std::shared_ptr<Polygon> get_current_polygon();
+        std::shared_ptr<Polygon> get_current_result();
+        std::shared_ptr<Polygon> get_current_window();
+        void on_im_gui_render_polygons();
+        void on_im_gui_render_windows();
+        void on_render(const glm::mat4& vp, Shader* shader);
+        void on_render_fill(const glm::mat4& vp, Shader* shader);
+        // - draws the same scene as on_render then on_render_fill on the cpu
+        void on_render_software(SoftwareRenderer& renderer);
+        void compute_bounding_box();
+        void clip();
+        void sutherland_ogdmann();
+        void greiner_hormann();
+        // - one result : the polygons <operation> the windows, each side being the union of its shapes
+        void boolean_operation(BooleanOperation operation);
+        void delete_current_polygon();
+        void delete_polygon(Polygon* p);
+        void delete_window(Polygon* p);
+        void delete_current_window();
+        void set_last_entry(bool b) { _is_last_entry_polygon = b; }
+        bool get_last_entry() { return _is_last_entry_polygon;  }
+        std::shared_ptr<Polygon> get_current_shape();
+        // - the result drawn on top at this point of the view, from the spans of its fill
+        std::shared_ptr<Polygon> get_result_at(float x, float y);
+        const ClipStats& get_clip_stats() const { return _clip_stats; }
+        void update_triangles();
+
+        bool enable_triangulation = false;
+        bool enable_bb = false;
+        // - clip against the windows themselves instead of their triangulation
+        bool enable_concave_clipping = true;
+        // - spread the polygon / window pairs over every core
+        bool enable_parallel_clipping = true;
+        // - sutherland-hodgman on the integer grid, shared edges give the same points
+        bool enable_exact_clipping = false;
+        // - replace the clipping by a boolean operation, selected_operation is a
+        // BooleanOperation (an int for the ImGui combo)
+        bool enable_boolean_operation = false;
+        int selected_operation = 0;
+        // - fill the results with trapezoids (a few triangles) instead of one line per pixel row
+        bool enable_trapezoid_fill = false;
+        // - fill the results that changed on every core, tall ones in bands of rows
+        bool enable_parallel_fill = true;
+        // - the cpu render fills the results with their exact pixel coverage
+        bool enable_antialiased_fill = false;
+        // - levels of subdivision (or fractal bumps) the S and R keys apply at once
+        int subdivision_levels = 1;
+        // - the S key only cuts the corners that still show : moved by more than the
+        // tolerance (in pixels), or turning by more than the max turn (in degrees).
+        // The levels are then a maximum
+        bool enable_adaptive_subdivision = false;
+        float subdivision_tolerance = 0.5f;
+        float subdivision_max_turn = 10.0f;
+    
+    private:
+        PolygonManager() = default;
+
+        // - triangles of a window in its own coordinates, found again from the hash of
+        // its points (then the points themselves, which the entry keeps). The revision
+        // only saves hashing and comparing the points of the same window again.
+        // The indices are what the window draws, the shapes built from them (no GL
+        // objects) are what sutherland-hodgman clips against
+        struct WindowTriangles
+        {
+            const Polygon* window = nullptr;
+            unsigned long long points_revision = 0;
+            unsigned long long hash = 0;
+            std::vector<float> points;
+            std::vector<int> contour_ends;
+            std::vector<int> indices;
+            std::vector<Shape> triangles;
+        };
+
+        void clip_pairs(const std::vector<const Shape*>& clippers, bool concave);
+
+        static PolygonManager* _instance;
+
+        int _current_polygon_index = -1;
+        int _current_window_index = -1;
+        unsigned int _polygon_id = 0;
+
         std::vector<std::shared_ptr<Polygon>> _polygons;
         std::vector<std::shared_ptr<Polygon>> _windows;
         std::vector<std::shared_ptr<Polygon>> _bounding_boxes;
-        std::vector<std::shared_ptr<Polygon>> _results;
-        std::vector<std::shared_ptr<Polygon>> _windows_triangles;
-        bool _is_last_entry_polygon = false;
-
+        std::vector<std::shared_ptr<Polygon>> _results;
+        // - what sutherland-hodgman clips against : convex windows themselves and the
+        // triangles of the other ones
+        std::vector<const Shape*> _convex_clippers;
+        // - window index of each of them, the fragments of one window are merged back
+        std::vector<int> _convex_clipper_windows;
+        bool _is_last_entry_polygon = false;
+        ClipStats _clip_stats;
+
+        // - clipping (and filling) runs on the pool, results are uploaded on the render thread
+        ClipStage _clip_stage;
+        std::unique_ptr<ThreadPool> _clip_pool;
+        std::vector<const Shape*> _clip_polygons;
+        std::vector<const Shape*> _clip_clippers;
+        FillStage _fill_stage;
+        std::vector<const Shape*> _fill_shapes;
+        std::vector<Polygon*> _fill_results;
+
+        // - each frame only refreshes what changed : triangles of the windows that
+        // changed, results clipped again and the bounding boxes of those results.
+        // They are found by comparing revisions with the ones used last time
+        std::vector<WindowTriangles> _triangle_cache;
+        std::vector<WindowTriangles> _previous_triangle_cache;
+        std::vector<unsigned long long> _result_revisions;
+        std::vector<unsigned long long> _bounding_box_revisions;
+        // - operation, then revisions of the polygons and windows, the boolean result was
+        // computed from. 0 for the result revision when it is empty
+        std::vector<unsigned long long> _boolean_inputs;
+        unsigned long long _boolean_result_revision = 0;
+
 };
\ No newline at end of file
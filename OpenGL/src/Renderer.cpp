@@ -45,6 +45,13 @@ void Renderer::draw(const VertexArray& va, const unsigned int count, const Shade
 	GL_CALL(glDrawArrays(GL_LINE_LOOP, 0, count));
 }
 
+void Renderer::draw(const VertexArray& va, const unsigned int first, const unsigned int count, const Shader& shader) const
+{
+	shader.bind();
+	va.bind();
+	GL_CALL(glDrawArrays(GL_LINE_LOOP, first, count));
+}
+
 
 void Renderer::draw_line(const VertexArray& va, const unsigned int count, const Shader& shader) const
 {
@@ -52,3 +59,30 @@ void Renderer::draw_line(const VertexArray& va, const unsigned int count, const
     va.bind();
     GL_CALL(glDrawArrays(GL_LINES, 0, count));
 }
+
+void Renderer::draw_triangles(const VertexArray& va, const unsigned int count, const Shader& shader) const
+{
+    shader.bind();
+    va.bind();
+    GL_CALL(glDrawArrays(GL_TRIANGLES, 0, count));
+}
+
+
+void Renderer::draw_triangles(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, const bool outline) const
+{
+    shader.bind();
+    va.bind();
+    ib.bind();
+
+    if (outline)
+    {
+        GL_CALL(glPolygonMode(GL_FRONT_AND_BACK, GL_LINE));
+    }
+
+    GL_CALL(glDrawElements(GL_TRIANGLES, ib.count(), GL_UNSIGNED_INT, nullptr));
+
+    if (outline)
+    {
+        GL_CALL(glPolygonMode(GL_FRONT_AND_BACK, GL_FILL));
+    }
+}
\ No newline at end of file
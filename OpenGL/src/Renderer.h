@@ -1,5 +1,6 @@
 #pragma once
 
+#include "IndexBuffer.h"
 #include "VertexArray.h"
 #include "Shader.h"
 
@@ -16,5 +17,9 @@ class Renderer
 public:
 	void clear() const;
 	void draw(const VertexArray& va, unsigned int count, const Shader& shader) const;
+	void draw(const VertexArray& va, unsigned int first, unsigned int count, const Shader& shader) const;
     void draw_line(const VertexArray& va, const unsigned int count, const Shader& shader) const;
+    void draw_triangles(const VertexArray& va, const unsigned int count, const Shader& shader) const;
+    // - the triangles of ib over the vertices of va in one call, outlined or filled
+    void draw_triangles(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, bool outline = false) const;
 };
\ No newline at end of file
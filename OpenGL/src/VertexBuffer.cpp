@@ -4,6 +4,7 @@
 #include <GL/glew.h>
 
 VertexBuffer::VertexBuffer(const void* data, unsigned int size)
+	:mCapacity_(size)
 {
 	GL_CALL(glGenBuffers(1, &mRendererId_));
 	GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, mRendererId_));
@@ -28,6 +29,17 @@ void VertexBuffer::unbind() const
 void VertexBuffer::edit(const void * data, unsigned int size)
 {
 	GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, mRendererId_));
-	GL_CALL(glBufferData(GL_ARRAY_BUFFER, size, data, GL_DYNAMIC_DRAW));
+
+	if (size > mCapacity_)
+	{
+		GL_CALL(glBufferData(GL_ARRAY_BUFFER, size, data, GL_DYNAMIC_DRAW));
+		mCapacity_ = size;
+	}
+	// - GL_CALL expands to several statements
+	else if (size > 0)
+	{
+		GL_CALL(glBufferSubData(GL_ARRAY_BUFFER, 0, size, data));
+	}
+
 	GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, 0));
 }
@@ -4,6 +4,8 @@ class VertexBuffer
 {
 private:
 	unsigned int mRendererId_;
+	// - bytes allocated on the gpu, edits that fit are written in place
+	unsigned int mCapacity_;
 public:
 	VertexBuffer(const void* data, unsigned int size);
 	~VertexBuffer();